@@ -0,0 +1,75 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <thread>
+
+#include <mcl/String.h>
+#include <mcl/StringAllocator.h>
+
+#include "Timer.h"
+
+using namespace mcl;
+
+#define ITERATIONS  2000000L
+#define MAX_THREADS 4
+#define LIVE        64
+
+static const char* VALUE = "a short value, too long to be stored locally";
+
+/**
+ * The work done by each thread: create and destroy short strings,
+ * keeping a few of them alive at once
+ */
+static void churn() {
+  String live[LIVE];
+  size_t len = strlen(VALUE);
+
+  for (long i = 0; i < ITERATIONS; i++)
+    live[i % LIVE] = String(VALUE, len - i % 8);
+  keep(live);
+}
+
+/**
+ * Run churn() on 1, 2 ... MAX_THREADS threads at once with allocator,
+ * reporting the time per string on each thread
+ */
+static void bench(const char* name, StringAllocator* allocator) {
+  char label[64];
+
+  StringAllocator::use(allocator);
+  for (int threads = 1; threads <= MAX_THREADS; threads *= 2) {
+    std::thread workers[MAX_THREADS];
+
+    Timer t;
+    for (int i = 0; i < threads; i++)
+      workers[i] = std::thread(churn);
+    for (int i = 0; i < threads; i++)
+      workers[i].join();
+
+    snprintf(label, sizeof(label), "%s (%d threads)", name, threads);
+    t.report(label, ITERATIONS);
+  }
+  StringAllocator::use(0);
+}
+
+int main(int argc, char** argv) {
+  printf("Short string churn\n");
+  bench("MallocAllocator", &MallocAllocator::instance());
+  bench("SlabAllocator", &SlabAllocator::instance());
+
+  SlabAllocator::Stats stats =
+    SlabAllocator::instance().stats(SlabAllocator::sizeClass(sizeof(StringRef)
+                                                            + strlen(VALUE)));
+  printf("  %lu-byte blocks: %lu allocations, %lu KB reserved\n",
+         (unsigned long)stats.blockSize, (unsigned long)stats.allocations,
+         (unsigned long)(stats.bytesReserved / 1024));
+
+  return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,66 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <mcl/String.h>
+#include <mcl/StringArena.h>
+
+#include "Timer.h"
+
+using namespace mcl;
+
+#define STRINGS    1000
+#define ITERATIONS 2000L
+
+static const char* VALUE = "a header value from a request, long enough";
+
+/**
+ * The work done for one request: create, copy and drop STRINGS
+ * temporary strings
+ */
+static size_t request(String* temps) {
+  size_t len = strlen(VALUE);
+  size_t total = 0;
+
+  for (int i = 0; i < STRINGS; i++) {
+    temps[i] = String(VALUE, len - i % 8);
+    String copy(temps[i]);
+    total += copy.size();
+  }
+  for (int i = 0; i < STRINGS; i++)
+    temps[i] = String();
+
+  return total;
+}
+
+/**
+ * Handle requests creating 1000 temporary strings each, with and
+ * without an arena per request
+ */
+int main(int argc, char** argv) {
+  static String temps[STRINGS];
+  size_t total = 0;
+
+  printf("Requests of %d temporary strings\n", STRINGS);
+
+  Timer t;
+  for (long i = 0; i < ITERATIONS; i++)
+    total += request(temps);
+  t.report("StringRef per string", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++) {
+    StringArena arena;
+    total += request(temps);
+  }
+  t.report("StringArena per request", ITERATIONS);
+
+  keep(total);
+  return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,72 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <stdio.h>
+
+#include <mcl/Atomic.h>
+
+#include "Timer.h"
+
+using namespace mcl;
+
+#define ITERATIONS 50000000L
+
+/**
+ * Reference count style increments and decrements with each memory
+ * order.  This program is built twice, once for each implementation
+ * of Atomic (BenchAtomic.bench and BenchAtomicAsm.bench).
+ */
+int main(int argc, char** argv) {
+#ifdef _MCL_ATOMIC_ASM
+  printf("Atomic (assembly)\n");
+#else
+  printf("Atomic (std::atomic)\n");
+#endif
+
+  Atomic<int> count(1);
+  int total = 0;
+
+  Timer t;
+  for (long i = 0; i < ITERATIONS; i++) {
+    count.fetchAdd(1, MEMORY_RELAXED);
+    total += count.fetchAdd(-1, MEMORY_ACQ_REL);
+  }
+  t.report("add relaxed, subtract acq_rel", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++) {
+    count.fetchAdd(1);
+    total += count.fetchAdd(-1);
+  }
+  t.report("add and subtract seq_cst", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++) {
+    int value = count.load(MEMORY_RELAXED);
+    while (!count.compareExchange(value, value + 1, MEMORY_ACQ_REL))
+      ;
+    total += value;
+  }
+  t.report("compare and exchange", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++) {
+    count.store((int)i, MEMORY_RELEASE);
+    total += count.load(MEMORY_ACQUIRE);
+  }
+  t.report("store release, load acquire", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++) {
+    count.store((int)i);
+    total += count.load();
+  }
+  t.report("store and load seq_cst", ITERATIONS);
+
+  keep(total);
+  return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
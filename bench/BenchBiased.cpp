@@ -0,0 +1,99 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <thread>
+
+#include <mcl/String.h>
+
+#include "Timer.h"
+
+using namespace mcl;
+
+#define ITERATIONS 10000000L
+#define HANDOFFS   1000000L
+
+static const char* VALUE = "a value long enough to need a StringRef";
+
+/**
+ * Copy and destroy a string created by the current thread
+ */
+static void benchCopy(const char* name) {
+  String orig(VALUE);
+  Timer t;
+  for (long i = 0; i < ITERATIONS; i++) {
+    String s(orig);
+    keep(s);
+  }
+  t.report(name, ITERATIONS);
+}
+
+/**
+ * Copy a string created by the current thread while another thread
+ * copies it too
+ */
+static void benchMixed(const char* name) {
+  String orig(VALUE);
+  std::thread other([&orig]() {
+      for (long i = 0; i < ITERATIONS / 10; i++) {
+        String s(orig);
+        keep(s);
+      }
+    });
+
+  Timer t;
+  for (long i = 0; i < ITERATIONS; i++) {
+    String s(orig);
+    keep(s);
+  }
+  t.report(name, ITERATIONS);
+  other.join();
+}
+
+/**
+ * Create strings on the current thread that are destroyed by another
+ */
+static void benchHandoff(const char* name) {
+  String* strings = new String[HANDOFFS];
+  String orig(VALUE);
+
+  Timer t;
+  for (long i = 0; i < HANDOFFS; i++)
+    strings[i] = orig;
+  orig = "";
+  std::thread other([strings]() { delete [] strings; });
+  other.join();
+
+  // the owner finishes releasing them with its next release
+  String last(VALUE);
+  last = "";
+  t.report(name, HANDOFFS);
+}
+
+/**
+ * Reference counting with atomic operations, and with biased reference
+ * counting for the thread that creates the strings
+ */
+int main(int argc, char** argv) {
+  printf("Biased reference counting\n");
+
+  benchCopy("copy (atomic)");
+  benchMixed("copy, second thread copying (atomic)");
+  benchHandoff("released by another thread (atomic)");
+
+  String::useBiasedReferences(true);
+
+  benchCopy("copy (biased)");
+  benchMixed("copy, second thread copying (biased)");
+  benchHandoff("released by another thread (biased)");
+
+  String::useBiasedReferences(false);
+
+  return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
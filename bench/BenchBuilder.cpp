@@ -0,0 +1,65 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+
+#include <mcl/String.h>
+#include <mcl/StringBuilder.h>
+
+#include "Timer.h"
+
+using namespace mcl;
+
+#define LINES      100
+#define ITERATIONS 100000L
+
+/**
+ * Build a response of about 4 KB from 100 header lines with a
+ * StringBuilder, and with std::string followed by a copy into a String
+ */
+int main(int argc, char** argv) {
+  String name("X-Benchmark-Header");
+  String value("some header value");
+  size_t total = 0;
+
+  printf("StringBuilder (%d lines)\n", LINES);
+
+  Timer t;
+  for (long i = 0; i < ITERATIONS; i++) {
+    StringBuilder b;
+    for (int j = 0; j < LINES; j++)
+      b.append(name).append(": ").append(value).append(' ').append(j)
+        .append('\n');
+    String response = b.toString();
+    total += response.size();
+  }
+  t.report("StringBuilder", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++) {
+    std::string b;
+    char num[16];
+    for (int j = 0; j < LINES; j++) {
+      b.append(name.data(), name.size());
+      b.append(": ");
+      b.append(value.data(), value.size());
+      b.append(" ");
+      snprintf(num, sizeof(num), "%d", j);
+      b.append(num);
+      b.append("\n");
+    }
+    String response(b.data(), b.size());
+    total += response.size();
+  }
+  t.report("std::string, then String", ITERATIONS);
+
+  keep(total);
+  return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,62 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <stdio.h>
+
+#include <mcl/Deque.h>
+#include <mcl/String.h>
+#include <mcl/Vector.h>
+
+#include "Timer.h"
+
+using namespace mcl;
+
+#define OPERATIONS 4000000L
+
+inline int makeInt(int i) { return i; }
+inline String makeString(int i) { return String::fromInt(i); }
+inline long weight(int i) { return i; }
+inline long weight(const String& s) { return s.size(); }
+
+/**
+ * Run a FIFO queue of the given length: each step pushes one item on
+ * the back and shifts one off the front
+ */
+template <class Q, class T>
+void fifo(const char* name, long length, long ops, T (*make)(int)) {
+  char label[64];
+  long total = 0;
+  Q q;
+
+  for (long i = 0; i < length; i++)
+    q.push(make((int)i));
+
+  Timer t;
+  for (long i = 0; i < ops; i++) {
+    q.push(make((int)i));
+    total += weight(q.shift());
+  }
+  snprintf(label, sizeof(label), "%s, length %ld", name, length);
+  t.report(label, ops);
+  keep(total);
+}
+
+int main(int argc, char** argv) {
+  printf("FIFO push + shift of ints:\n");
+  fifo<Deque<int> >("Deque", 16, OPERATIONS, makeInt);
+  fifo<Vector<int> >("Vector", 16, OPERATIONS, makeInt);
+  fifo<Deque<int> >("Deque", 1000, OPERATIONS, makeInt);
+  fifo<Vector<int> >("Vector", 1000, OPERATIONS / 10, makeInt);
+  fifo<Deque<int> >("Deque", 100000, OPERATIONS, makeInt);
+  fifo<Vector<int> >("Vector", 100000, OPERATIONS / 1000, makeInt);
+
+  printf("FIFO push + shift of Strings:\n");
+  fifo<Deque<String> >("Deque", 1000, OPERATIONS, makeString);
+  fifo<Vector<String> >("Vector", 1000, OPERATIONS / 10, makeString);
+
+  return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,72 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <mcl/String.h>
+
+#include "Timer.h"
+
+using namespace mcl;
+
+#define FILE_SIZE  (64L * 1024 * 1024)
+#define ITERATIONS 10L
+
+/**
+ * Load a 64 MB file and count its lines, with String::fromFile(), and
+ * by reading it into a buffer that is then copied into a String
+ */
+int main(int argc, char** argv) {
+  char path[] = "/tmp/BenchFileXXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    perror("mkstemp");
+    return 1;
+  }
+
+  char line[64];
+  memset(line, 'x', sizeof(line));
+  line[sizeof(line) - 1] = '\n';
+  for (long written = 0; written < FILE_SIZE; written += sizeof(line)) {
+    if (write(fd, line, sizeof(line)) != (ssize_t)sizeof(line)) {
+      perror("write");
+      return 1;
+    }
+  }
+  close(fd);
+
+  size_t total = 0;
+
+  printf("Loading a %ld MB file\n", FILE_SIZE / (1024 * 1024));
+
+  Timer t;
+  for (long i = 0; i < ITERATIONS; i++) {
+    String contents = String::fromFile(path);
+    total += contents.count('\n');
+  }
+  t.report("fromFile", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++) {
+    FILE* fp = fopen(path, "rb");
+    char* buf = (char*)malloc(FILE_SIZE);
+    size_t len = fread(buf, 1, FILE_SIZE, fp);
+    fclose(fp);
+    String contents(buf, len);
+    free(buf);
+    total += contents.count('\n');
+  }
+  t.report("fread, then copy", ITERATIONS);
+
+  remove(path);
+
+  keep(total);
+  return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
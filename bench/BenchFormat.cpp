@@ -0,0 +1,63 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <mcl/String.h>
+
+#include "Timer.h"
+
+using namespace mcl;
+
+#define ITERATIONS 1000000L
+
+/**
+ * Format a log line with String::format(), with a Format parsed in
+ * advance, and with snprintf() called to measure the result and again
+ * to write it before it is copied into a String
+ */
+int main(int argc, char** argv) {
+  String user("jeffrey");
+  String path("/index.html");
+  size_t total = 0;
+
+  printf("log line\n");
+
+  Timer t;
+  for (long i = 0; i < ITERATIONS; i++) {
+    String line = String::format("%s GET %s %d %ld bytes", user, path, 200,
+                                 i);
+    total += line.size();
+  }
+  t.report("String::format", ITERATIONS);
+
+  Format fmt("%s GET %s %d %ld bytes");
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++) {
+    String line = String::format(fmt, user, path, 200, i);
+    total += line.size();
+  }
+  t.report("String::format (Format)", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++) {
+    const char* f = "%.*s GET %.*s %d %ld bytes";
+    int len = snprintf(0, 0, f, (int)user.size(), user.data(),
+                       (int)path.size(), path.data(), 200, i);
+    char* buf = static_cast<char*>(malloc(len + 1));
+    snprintf(buf, len + 1, f, (int)user.size(), user.data(),
+             (int)path.size(), path.data(), 200, i);
+    String line(buf, len);
+    free(buf);
+    total += line.size();
+  }
+  t.report("snprintf twice, then String", ITERATIONS);
+
+  keep(total);
+  return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,97 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mcl/String.h>
+
+#include "Timer.h"
+
+using namespace mcl;
+
+#define ITERATIONS 1000000L
+
+/**
+ * Convert numbers to Strings and back with the String functions, and
+ * with snprintf(), strtoll() and strtod()
+ */
+int main(int argc, char** argv) {
+  long long ints[256];
+  double doubles[256];
+  String intStrings[256];
+  String doubleStrings[256];
+  char intText[256][32];
+  char doubleText[256][32];
+
+  srand(1);
+  for (int i = 0; i < 256; i++) {
+    ints[i] = ((long long)rand() << 31) ^ rand();
+    doubles[i] = (double)rand() / (rand() + 1);
+    intStrings[i] = String::fromInt(ints[i]);
+    doubleStrings[i] = String::fromDouble(doubles[i]);
+    memcpy(intText[i], intStrings[i].data(), intStrings[i].size());
+    intText[i][intStrings[i].size()] = 0;
+    memcpy(doubleText[i], doubleStrings[i].data(), doubleStrings[i].size());
+    doubleText[i][doubleStrings[i].size()] = 0;
+  }
+
+  size_t total = 0;
+  char buf[64];
+
+  printf("integers\n");
+
+  Timer t;
+  for (long i = 0; i < ITERATIONS; i++)
+    total += String::fromInt(ints[i & 255]).size();
+  t.report("String::fromInt", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++) {
+    int len = snprintf(buf, sizeof(buf), "%lld", ints[i & 255]);
+    total += String(buf, len).size();
+  }
+  t.report("snprintf", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++)
+    total += (size_t)intStrings[i & 255].toInt64();
+  t.report("String::toInt64", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++)
+    total += (size_t)strtoll(intText[i & 255], 0, 10);
+  t.report("strtoll", ITERATIONS);
+
+  printf("doubles\n");
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++)
+    total += String::fromDouble(doubles[i & 255]).size();
+  t.report("String::fromDouble", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++) {
+    int len = snprintf(buf, sizeof(buf), "%.17g", doubles[i & 255]);
+    total += String(buf, len).size();
+  }
+  t.report("snprintf %.17g", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++)
+    total += (size_t)doubleStrings[i & 255].toDouble();
+  t.report("String::toDouble", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++)
+    total += (size_t)strtod(doubleText[i & 255], 0);
+  t.report("strtod", ITERATIONS);
+
+  keep(total);
+  return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,70 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <mcl/String.h>
+#include <mcl/StringBuilder.h>
+#include <mcl/Rope.h>
+
+#include "Timer.h"
+
+using namespace mcl;
+
+#define DOCUMENT   (8L * 1024 * 1024)
+#define ITERATIONS 1000L
+
+/**
+ * Insert short strings at scattered positions in an 8 MB document held
+ * in a Rope, and in a String rebuilt around each insertion
+ */
+int main(int argc, char** argv) {
+  StringBuilder b(DOCUMENT);
+  for (long i = 0; i < DOCUMENT; i++)
+    b.append((char)('a' + i % 26));
+  String document = b.toString();
+  String insertion("<inserted text>");
+  size_t total = 0;
+
+  printf("Insertions into a %ld MB document\n", DOCUMENT / (1024 * 1024));
+
+  Timer t;
+  Rope rope(document);
+  unsigned int seed = 1;
+  for (long i = 0; i < ITERATIONS; i++) {
+    seed = seed * 1103515245 + 12345;
+    size_t pos = (seed >> 8) % (rope.size() + 1);
+    rope = rope.insert(pos, Rope(insertion));
+    total += rope.charAt(pos);
+  }
+  total += rope.size();
+  t.report("Rope insert", ITERATIONS);
+
+  t.reset();
+  String str = rope.flatten();
+  total += str.size();
+  t.report("Rope flatten", 1);
+
+  t.reset();
+  str = document;
+  seed = 1;
+  for (long i = 0; i < ITERATIONS; i++) {
+    seed = seed * 1103515245 + 12345;
+    size_t pos = (seed >> 8) % (str.size() + 1);
+    StringBuilder edit(str.size() + insertion.size());
+    edit.append(str.data(), pos).append(insertion)
+      .append(str.data() + pos, str.size() - pos);
+    str = edit.toString();
+    total += str.data()[pos];
+  }
+  total += str.size();
+  t.report("String insert", ITERATIONS);
+
+  keep(total);
+  return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
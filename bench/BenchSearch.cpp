@@ -0,0 +1,94 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+
+#include <mcl/String.h>
+
+#include "Timer.h"
+
+using namespace mcl;
+
+#define SIZE       (1024 * 1024)
+#define ITERATIONS 200L
+
+/**
+ * Searches of a 1 MB block of text for values near its end, using
+ * String and std::string
+ */
+int main(int argc, char** argv) {
+  // a haystack of lowercase text with no uppercase letters
+  char* buf = new char[SIZE];
+  for (int i = 0; i < SIZE; i++)
+    buf[i] = (i % 61 == 60) ? ' ' : 'a' + (i * 7) % 26;
+  memcpy(buf + SIZE - 40, "Needle in a Haystack", 20);
+
+  String str(buf, SIZE);
+  std::string stdStr(buf, SIZE);
+  delete [] buf;
+
+  String needle("Haystack");
+  std::string stdNeedle("Haystack");
+  long total = 0;
+
+  printf("Search (%d KB)\n", SIZE / 1024);
+
+  Timer t;
+  for (long i = 0; i < ITERATIONS; i++)
+    total += str.find('N');
+  t.report("find(char) String", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++)
+    total += stdStr.find('N');
+  t.report("find(char) std::string", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++)
+    total += str.find(needle);
+  t.report("find(String) String", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++)
+    total += stdStr.find(stdNeedle);
+  t.report("find(String) std::string", ITERATIONS);
+
+  // a needle whose first character is common in the haystack
+  String common("abNeedle");
+  std::string stdCommon("abNeedle");
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++)
+    total += str.find(common);
+  t.report("find(String) common start String", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++)
+    total += stdStr.find(stdCommon);
+  t.report("find(String) common start std::string", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++)
+    total += str.rfind("xyz");
+  t.report("rfind String", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++)
+    total += stdStr.rfind("xyz");
+  t.report("rfind std::string", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++)
+    total += str.count(' ');
+  t.report("count(char) String", ITERATIONS);
+
+  keep(total);
+  return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
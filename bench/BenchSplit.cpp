@@ -0,0 +1,84 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <mcl/String.h>
+#include <mcl/StringTokenizer.h>
+#include <mcl/Vector.h>
+
+#include "Timer.h"
+
+using namespace mcl;
+
+#define FIELDS     100
+#define ITERATIONS 20000L
+
+/**
+ * Splitting a record of 100 comma-separated fields by copying each
+ * field, with split() and with a StringTokenizer
+ */
+int main(int argc, char** argv) {
+  // a record of short and long fields
+  char buf[FIELDS * 40];
+  char* p = buf;
+  for (int i = 0; i < FIELDS; i++) {
+    if (i)
+      *p++ = ',';
+    int len = (i % 4 == 0) ? 32 : 3 + i % 9;
+    for (int j = 0; j < len; j++)
+      *p++ = 'a' + (i + j) % 26;
+  }
+  *p = 0;
+
+  String line(buf);
+  size_t total = 0;
+
+  printf("Split (%d fields, %lu bytes)\n", FIELDS, (unsigned long)line.size());
+
+  Timer t;
+  for (long i = 0; i < ITERATIONS; i++) {
+    Vector<String> fields(FIELDS);
+    const char* d = line.data();
+    const char* end = d + line.size();
+    for (;;) {
+      const char* comma = (const char*)memchr(d, ',', end - d);
+      const char* stop = comma ? comma : end;
+      fields.append(String(d, (size_t)(stop - d)));
+      if (!comma)
+        break;
+      d = comma + 1;
+    }
+    total += fields.size();
+  }
+  t.report("copy each field into Vector", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++) {
+    Vector<String> fields(FIELDS);
+    total += line.split(',', fields);
+  }
+  t.report("split into Vector", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++)
+    total += line.split(',', [&total](const String& f) { total += f.size(); });
+  t.report("split with callback", ITERATIONS);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS; i++) {
+    StringTokenizer tokens(line, ',');
+    String field;
+    while (tokens.next(field))
+      total += field.size();
+  }
+  t.report("StringTokenizer", ITERATIONS);
+
+  keep(total);
+  return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,139 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <mcl/String.h>
+
+#include "Timer.h"
+
+using namespace mcl;
+
+#define ITERATIONS 10000000L
+
+/**
+ * Strings stored locally (SHORT) and just long enough to require a
+ * shared StringRef (LONG), which is how every String was stored
+ * before local storage.
+ */
+static const char* SHORT = "Content-Type";
+static const char* LONG  = "Content-Type-Options-X1";
+
+/**
+ * Construct and destroy a String from a C string
+ */
+void benchConstruct(const char* name, const char* value) {
+  Timer t;
+  for (long i = 0; i < ITERATIONS; i++) {
+    String s(value);
+    keep(s);
+  }
+  t.report(name, ITERATIONS);
+}
+
+/**
+ * Construct and destroy a String from a literal (LONG) without copying
+ */
+void benchLiteral(const char* name) {
+  using namespace mcl::literals;
+  Timer t;
+  for (long i = 0; i < ITERATIONS; i++) {
+    String s = "Content-Type-Options-X1"_str;
+    keep(s);
+  }
+  t.report(name, ITERATIONS);
+}
+
+/**
+ * Copy and destroy an existing String
+ */
+void benchCopy(const char* name, const char* value) {
+  String orig(value);
+  Timer t;
+  for (long i = 0; i < ITERATIONS; i++) {
+    String s(orig);
+    keep(s);
+  }
+  t.report(name, ITERATIONS);
+}
+
+/**
+ * Copy and destroy a String referring to a literal
+ */
+void benchCopyLiteral(const char* name) {
+  String orig = String::literal(LONG, strlen(LONG));
+  Timer t;
+  for (long i = 0; i < ITERATIONS; i++) {
+    String s(orig);
+    keep(s);
+  }
+  t.report(name, ITERATIONS);
+}
+
+/**
+ * Compare two equal Strings with distinct data
+ */
+void benchCompare(const char* name, const char* value) {
+  String a(value);
+  String b(value);
+  int total = 0;
+  Timer t;
+  for (long i = 0; i < ITERATIONS; i++) {
+    keep(a);
+    total += (a == b);
+  }
+  t.report(name, ITERATIONS);
+  keep(total);
+}
+
+/**
+ * Order two long keys differing only in their last byte, using String
+ * comparison and strcmp on the same data
+ */
+void benchLongCompare() {
+  char buf[1024];
+  memset(buf, 'k', sizeof(buf));
+  buf[sizeof(buf) - 1] = 0;
+
+  String a(buf);
+  buf[sizeof(buf) - 2] = 'l';
+  String b(buf);
+
+  int total = 0;
+  Timer t;
+  for (long i = 0; i < ITERATIONS / 10; i++) {
+    keep(a);
+    total += (a < b);
+  }
+  t.report("compare 1 KB keys (String)", ITERATIONS / 10);
+
+  t.reset();
+  for (long i = 0; i < ITERATIONS / 10; i++) {
+    keep(a);
+    total += (strcmp(a, b) < 0);
+  }
+  t.report("compare 1 KB keys (strcmp)", ITERATIONS / 10);
+  keep(total);
+}
+
+int main(int argc, char** argv) {
+  printf("String (local: %d bytes, shared: %d bytes)\n",
+         (int)strlen(SHORT), (int)strlen(LONG));
+
+  benchConstruct("construct local", SHORT);
+  benchConstruct("construct shared", LONG);
+  benchLiteral("construct literal");
+  benchCopy("copy local", SHORT);
+  benchCopy("copy shared", LONG);
+  benchCopyLiteral("copy literal");
+  benchCompare("compare local", SHORT);
+  benchCompare("compare shared", LONG);
+  benchLongCompare();
+
+  return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
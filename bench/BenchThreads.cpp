@@ -0,0 +1,94 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <thread>
+
+#include <mcl/String.h>
+
+#include "Timer.h"
+
+using namespace mcl;
+
+#define ITERATIONS  5000000L
+#define MAX_THREADS 8
+
+/**
+ * Strings shared by every thread
+ */
+static const char* VALUE = "a value shared by every thread";
+static String counted(VALUE);
+static String immortal(VALUE);
+static String literal = String::literal(VALUE, strlen(VALUE));
+
+/**
+ * The work done by each thread
+ */
+static void construct() {
+  for (long i = 0; i < ITERATIONS; i++) {
+    String s;
+    keep(s);
+  }
+}
+
+static void copyCounted() {
+  for (long i = 0; i < ITERATIONS; i++) {
+    String s(counted);
+    keep(s);
+  }
+}
+
+static void copyImmortal() {
+  for (long i = 0; i < ITERATIONS; i++) {
+    String s(immortal);
+    keep(s);
+  }
+}
+
+static void copyLiteral() {
+  for (long i = 0; i < ITERATIONS; i++) {
+    String s(literal);
+    keep(s);
+  }
+}
+
+/**
+ * Run work on 1, 2, 4 ... MAX_THREADS threads at once, reporting the
+ * time per operation on each thread.  Times that stay flat as threads
+ * are added indicate that the threads do not contend with each other.
+ */
+static void bench(const char* name, void (*work)()) {
+  char label[64];
+
+  for (int threads = 1; threads <= MAX_THREADS; threads *= 2) {
+    std::thread workers[MAX_THREADS];
+
+    Timer t;
+    for (int i = 0; i < threads; i++)
+      workers[i] = std::thread(work);
+    for (int i = 0; i < threads; i++)
+      workers[i].join();
+
+    snprintf(label, sizeof(label), "%s (%d threads)", name, threads);
+    t.report(label, ITERATIONS);
+  }
+}
+
+int main(int argc, char** argv) {
+  immortal.makeImmortal();
+
+  printf("Threads (%u processors)\n", std::thread::hardware_concurrency());
+
+  bench("default construct", construct);
+  bench("copy counted", copyCounted);
+  bench("copy immortal", copyImmortal);
+  bench("copy literal", copyLiteral);
+
+  return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
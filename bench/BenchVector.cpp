@@ -0,0 +1,212 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <stdio.h>
+
+#include <mcl/String.h>
+#include <mcl/SmallVector.h>
+#include <mcl/Vector.h>
+
+#include "Timer.h"
+
+using namespace mcl;
+
+#define ELEMENTS   1000000L
+#define ROUNDS     20
+
+/**
+ * An int stored in a separate allocation, as every Vector item once was
+ */
+struct BoxedInt {
+  int value;
+  BoxedInt(int v) : value(v) { }
+};
+
+namespace mcl {
+template <> struct vector_stores_pointers<BoxedInt> {
+  static const bool value = true;
+};
+}
+
+/**
+ * A String moved element by element, as types that are not trivially
+ * relocatable are
+ */
+struct WrappedString {
+  String s;
+  WrappedString(const String& str) : s(str) { }
+};
+
+inline int valueOf(int v) { return v; }
+inline int valueOf(const BoxedInt& b) { return b.value; }
+
+/**
+ * Push, iterate over and copy a list of items stored in the array, and
+ * one of items stored separately
+ */
+template <class T> void run(const char* name) {
+  char label[64];
+  size_t total = 0;
+
+  Timer t;
+  for (int r = 0; r < ROUNDS; r++) {
+    Vector<T> v;
+    for (long i = 0; i < ELEMENTS; i++)
+      v.push(T((int)i));
+    total += v.size();
+  }
+  snprintf(label, sizeof(label), "push (%s)", name);
+  t.report(label, ROUNDS * ELEMENTS);
+
+  Vector<T> v;
+  for (long i = 0; i < ELEMENTS; i++)
+    v.push(T((int)i));
+
+  t.reset();
+  for (int r = 0; r < ROUNDS; r++) {
+    long sum = 0;
+    for (size_t i = 0; i < v.size(); i++)
+      sum += valueOf(v[i]);
+    total += sum;
+  }
+  snprintf(label, sizeof(label), "iterate (%s)", name);
+  t.report(label, ROUNDS * ELEMENTS);
+
+  t.reset();
+  for (int r = 0; r < ROUNDS; r++) {
+    Vector<T> copy(v);
+    total += valueOf(copy[r]);
+  }
+  snprintf(label, sizeof(label), "copy (%s)", name);
+  t.report(label, ROUNDS * ELEMENTS);
+
+  keep(total);
+}
+
+/**
+ * Load a list of ints with each growth policy, with reserve() and with
+ * appendRange(), reporting the capacity left over
+ */
+void load() {
+  static int source[ELEMENTS];
+  for (long i = 0; i < ELEMENTS; i++)
+    source[i] = (int)i;
+
+  const char* names[] = { "push, 1.5x growth", "push, 2x growth",
+                          "push, 4x growth" };
+  Vector<int>::Growth policies[] = { Vector<int>::GROW_BY_HALF,
+                                     Vector<int>::GROW_DOUBLE,
+                                     Vector<int>::GROW_FOUR_TIMES };
+  char label[64];
+  size_t total = 0;
+  size_t slack = 0;
+
+  for (int p = 0; p < 3; p++) {
+    Timer t;
+    for (int r = 0; r < ROUNDS; r++) {
+      Vector<int> v;
+      v.setGrowthPolicy(policies[p]);
+      for (long i = 0; i < ELEMENTS; i++)
+        v.push(source[i]);
+      total += v[r];
+      slack = v.capacity() - v.size();
+    }
+    snprintf(label, sizeof(label), "%s (%zu spare)", names[p], slack);
+    t.report(label, ROUNDS * ELEMENTS);
+  }
+
+  Timer t;
+  for (int r = 0; r < ROUNDS; r++) {
+    Vector<int> v;
+    v.reserve(ELEMENTS);
+    for (long i = 0; i < ELEMENTS; i++)
+      v.push(source[i]);
+    total += v[r];
+  }
+  t.report("reserve, then push", ROUNDS * ELEMENTS);
+
+  t.reset();
+  for (int r = 0; r < ROUNDS; r++) {
+    Vector<int> v;
+    v.appendRange(source, ELEMENTS);
+    total += v[r];
+  }
+  t.report("appendRange", ROUNDS * ELEMENTS);
+
+  keep(total);
+}
+
+/**
+ * Build and discard many lists of three Strings, as a parser does for
+ * short lists of tags
+ */
+template <class L> void shortLists(const char* name, const String* tags) {
+  size_t total = 0;
+
+  Timer t;
+  for (long i = 0; i < ELEMENTS; i++) {
+    L list;
+    for (int j = 0; j < 3; j++)
+      list.push(tags[(i + j) % 8]);
+    total += list[i % 3].size();
+  }
+  t.report(name, ELEMENTS);
+  keep(total);
+}
+
+int main(int argc, char** argv) {
+  printf("Vector of %ld items\n", ELEMENTS);
+
+  run<int>("int, in the array");
+  run<BoxedInt>("int, separately");
+
+  // Strings (one pointer each, shared with the copies)
+  String shared("a string long enough to be shared by its copies");
+  size_t total = 0;
+
+  Timer t;
+  for (int r = 0; r < ROUNDS; r++) {
+    Vector<String> v;
+    for (long i = 0; i < ELEMENTS; i++)
+      v.push(shared);
+    total += v.size();
+  }
+  t.report("push (String)", ROUNDS * ELEMENTS);
+  keep(total);
+
+  // inserting at the front moves every item each time
+  t.reset();
+  for (int r = 0; r < ROUNDS; r++) {
+    Vector<String> v;
+    for (long i = 0; i < 10000; i++)
+      v.unshift(shared);
+    total += v.size();
+  }
+  t.report("unshift 10000 (String, memmove)", ROUNDS * 10000);
+
+  t.reset();
+  for (int r = 0; r < ROUNDS; r++) {
+    Vector<WrappedString> v;
+    for (long i = 0; i < 10000; i++)
+      v.unshift(WrappedString(shared));
+    total += v.size();
+  }
+  t.report("unshift 10000 (String, one by one)", ROUNDS * 10000);
+  keep(total);
+
+  printf("loading %ld ints\n", ELEMENTS);
+  load();
+
+  printf("lists of 3 Strings\n");
+  String tags[8];
+  for (int i = 0; i < 8; i++)
+    tags[i] = String::format("a tag long enough to be shared %d", i);
+  shortLists<Vector<String> >("build (Vector)", tags);
+  shortLists<SmallVector<String, 4> >("build (SmallVector<String, 4>)", tags);
+
+  return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
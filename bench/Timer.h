@@ -0,0 +1,55 @@
+#ifndef _MCL_bench_Timer_h_
+#define _MCL_bench_Timer_h_
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+/**
+ * A minimal timer for the benchmark programs
+ */
+
+#include <stdio.h>
+#include <sys/time.h>
+
+/**
+ * Timer measures the wall clock time between its construction (or the
+ * last call to reset()) and a call to report().
+ */
+class Timer {
+
+public:
+
+  /** Constructor (starts timing) */
+  Timer() { reset(); }
+
+  /** Restart timing */
+  void reset() { gettimeofday(&start, 0); }
+
+  /** Return the number of seconds elapsed */
+  double elapsed() const {
+    struct timeval now;
+    gettimeofday(&now, 0);
+    return (now.tv_sec - start.tv_sec) + (now.tv_usec - start.tv_usec) / 1e6;
+  }
+
+  /** Print the time per iteration for a named test */
+  void report(const char* name, long iterations) const {
+    double secs = elapsed();
+    printf("  %-40s %8.2f ns/op\n", name, secs * 1e9 / iterations);
+  }
+
+protected:
+  struct timeval start;
+};
+
+/**
+ * Keep the compiler from optimizing away a computed value
+ */
+template <class T> inline void keep(const T& value) {
+  __asm__ __volatile__ ("" : : "g" (&value) : "memory");
+}
+
+#endif // _MCL_bench_Timer_h_
+
+// Local Variables:
+// mode:C++
+// End:
@@ -4,12 +4,25 @@
 // See the LICENSE file distributed with this work for restrictions.
 
 /**
- * Macros for atomic operations
+ * Atomic operations
+ *
+ * Two implementations are available, selected in config.h: one built
+ * on std::atomic (_MCL_ATOMIC_STD, the default, which supports any
+ * processor the compiler does), and one using the inline assembly
+ * macros for x86 processors in mcl/arch (_MCL_ATOMIC_ASM).
  */
 
 #include <mcl/config.h>
 
-#if _MCL_ARCH == _MCL_ARCH_X86
+#ifdef _MCL_ATOMIC_STD
+
+#include <atomic>
+
+#else // _MCL_ATOMIC_ASM
+
+#if _MCL_ARCH != _MCL_ARCH_X86 && _MCL_ARCH != _MCL_ARCH_X86_64
+#error "Assembly atomic operations are only available for x86 processors"
+#endif
 
 #ifdef _MCL_MASM_SYNTAX
 #include <mcl/arch/Atomic_i486_masm.h>
@@ -17,12 +30,204 @@
 #include <mcl/arch/Atomic_i486_att.h>
 #endif
 
+#include <stdint.h>
+#include <string.h>
+
+#endif
+
+namespace mcl {
+
+/**
+ * The ordering constraints of an atomic operation, with the same
+ * meanings as the std::memory_order values of the same names.
+ */
+enum MemoryOrder {
+  MEMORY_RELAXED,
+  MEMORY_ACQUIRE,
+  MEMORY_RELEASE,
+  MEMORY_ACQ_REL,
+  MEMORY_SEQ_CST
+};
+
+/**
+ * Atomic holds a value of type T (an integer, bool or pointer) that may
+ * be read and modified by multiple threads at once.  Every operation
+ * takes the MemoryOrder it requires, which defaults to the strongest
+ * (sequentially consistent) ordering.
+ *
+ * The assembly implementation supports fetchAdd() only for 32-bit
+ * types, and exchange() and compareExchange() only for 32-bit and
+ * pointer-sized types.  It always performs these read-modify-write
+ * operations with a full barrier, as x86
+ * locked instructions do.  Its loads and stores are ordinary
+ * instructions, which x86 processors already order as acquire and
+ * release operations.
+ */
+template <class T> class Atomic {
+
+public:
+
+  /** Constructor */
+  Atomic(T value = T()) : value(value) { }
+
+  inline T load(MemoryOrder order = MEMORY_SEQ_CST) const;
+  inline void store(T val, MemoryOrder order = MEMORY_SEQ_CST);
+  inline T exchange(T val, MemoryOrder order = MEMORY_SEQ_CST);
+  inline bool compareExchange(T& expected, T desired,
+                              MemoryOrder order = MEMORY_SEQ_CST);
+  inline T fetchAdd(T val, MemoryOrder order = MEMORY_SEQ_CST);
+  inline T fetchSub(T val, MemoryOrder order = MEMORY_SEQ_CST)
+    { return fetchAdd(0 - val, order); }
+
+protected:
+  // not copyable
+  Atomic(const Atomic<T>&);
+  Atomic<T>& operator=(const Atomic<T>&);
+
+#ifdef _MCL_ATOMIC_STD
+  static inline std::memory_order stdOrder(MemoryOrder order);
+
+  std::atomic<T> value;
 #else
+  /** Convert between T and the integer type W of the same size */
+  template <class W, class U> static W convert(U val)
+    { W result; memcpy(&result, &val, sizeof(W)); return result; }
+
+  volatile T value;
+#endif
+};
+
+#ifdef _MCL_ATOMIC_STD
+
+/**
+ * Return the std::memory_order equivalent to order.
+ */
+template <class T>
+inline std::memory_order Atomic<T>::stdOrder(MemoryOrder order) {
+  switch (order) {
+  case MEMORY_RELAXED: return std::memory_order_relaxed;
+  case MEMORY_ACQUIRE: return std::memory_order_acquire;
+  case MEMORY_RELEASE: return std::memory_order_release;
+  case MEMORY_ACQ_REL: return std::memory_order_acq_rel;
+  default:             return std::memory_order_seq_cst;
+  }
+}
+
+/**
+ * Return the value.
+ */
+template <class T> inline T Atomic<T>::load(MemoryOrder order) const {
+  return value.load(stdOrder(order));
+}
+
+/**
+ * Replace the value with val.
+ */
+template <class T> inline void Atomic<T>::store(T val, MemoryOrder order) {
+  value.store(val, stdOrder(order));
+}
+
+/**
+ * Replace the value with val, returning the previous value.
+ */
+template <class T> inline T Atomic<T>::exchange(T val, MemoryOrder order) {
+  return value.exchange(val, stdOrder(order));
+}
+
+/**
+ * If the value equals expected, replace it with desired and return
+ * true.  Otherwise, load the value into expected and return false.
+ * (This may fail even if the value equals expected, so it is normally
+ * called in a loop.)
+ */
+template <class T> inline bool Atomic<T>::compareExchange(T& expected,
+                                                          T desired,
+                                                          MemoryOrder order) {
+  // a failed exchange only loads, so it may not use a release ordering
+  std::memory_order failure =
+    (order == MEMORY_RELEASE) ? std::memory_order_relaxed :
+    (order == MEMORY_ACQ_REL) ? std::memory_order_acquire : stdOrder(order);
+
+  return value.compare_exchange_weak(expected, desired, stdOrder(order),
+                                     failure);
+}
+
+/**
+ * Add val to the value, returning the previous value.
+ */
+template <class T> inline T Atomic<T>::fetchAdd(T val, MemoryOrder order) {
+  return value.fetch_add(val, stdOrder(order));
+}
+
+#else // _MCL_ATOMIC_ASM
+
+template <class T> inline T Atomic<T>::load(MemoryOrder) const {
+  T val = value;
+  AtomicCompilerBarrier();
+  return val;
+}
+
+template <class T> inline void Atomic<T>::store(T val, MemoryOrder order) {
+  AtomicCompilerBarrier();
+  value = val;
+
+  // only a sequentially consistent store must wait for later loads
+  if (order == MEMORY_SEQ_CST)
+    AtomicFence();
+}
+
+template <class T> inline T Atomic<T>::exchange(T val, MemoryOrder) {
+  static_assert(sizeof(T) == sizeof(int) || sizeof(T) == sizeof(intptr_t),
+                "32-bit or pointer-sized values only");
+  if (sizeof(T) == sizeof(int)) {
+    int prev = 0;
+    AtomicExchange((int*)&value, convert<int>(val), prev);
+    return convert<T>(prev);
+  }
 
-#error "Unknown architecture"
+  intptr_t prev = 0;
+  AtomicExchangePtr((intptr_t*)&value, convert<intptr_t>(val), prev);
+  return convert<T>(prev);
+}
+
+template <class T> inline bool Atomic<T>::compareExchange(T& expected,
+                                                          T desired,
+                                                          MemoryOrder) {
+  static_assert(sizeof(T) == sizeof(int) || sizeof(T) == sizeof(intptr_t),
+                "32-bit or pointer-sized values only");
+  if (sizeof(T) == sizeof(int)) {
+    int prev = 0;
+    int old = convert<int>(expected);
+    AtomicCompareExchange((int*)&value, old, convert<int>(desired), prev);
+    if (prev == old)
+      return true;
+
+    expected = convert<T>(prev);
+    return false;
+  }
+
+  intptr_t prev = 0;
+  intptr_t old = convert<intptr_t>(expected);
+  AtomicCompareExchangePtr((intptr_t*)&value, old, convert<intptr_t>(desired),
+                           prev);
+  if (prev == old)
+    return true;
+
+  expected = convert<T>(prev);
+  return false;
+}
+
+template <class T> inline T Atomic<T>::fetchAdd(T val, MemoryOrder) {
+  static_assert(sizeof(T) == sizeof(int), "32-bit values only");
+  int prev = 0;
+  AtomicAdd((int*)&value, (int)val, prev);
+  return (T)prev;
+}
 
 #endif
 
+} // namespace
+
 #endif // _MCL_Atomic_h_
 
 // Local Variables:
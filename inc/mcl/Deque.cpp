@@ -0,0 +1,315 @@
+/**
+ * Default constructor that accepts an optional capacity argument,
+ * which is rounded up to a power of two.
+ *
+ * @param capacity The initial capacity of the deque.
+ */
+template <class T> inline Deque<T>::Deque(int capacity)
+  : elems(0), head(0), count(0), cap(0) {
+  if (capacity > 0)
+    reallocate(roundCapacity(capacity));
+}
+
+/**
+ * Copy constructor.  Performs a deep copy of list.  No memory is
+ * allocated for a copy of an empty deque.
+ *
+ * @param list The deque to copy
+ */
+template <class T> inline Deque<T>::Deque(const Deque<T>& list)
+  : elems(0), head(0), count(0), cap(0) {
+  if (list.count)
+    reallocate(roundCapacity(list.count));
+
+  for (size_t i = 0; i < list.count; i++) {
+    Storage::construct(elems + i, Storage::get(*list.slot(i)));
+    count++;
+  }
+}
+
+/**
+ * Move constructor.  Takes over the contents of list, which is left
+ * empty.
+ *
+ * @param list The deque to move
+ */
+template <class T> inline Deque<T>::Deque(Deque<T>&& list)
+  : elems(list.elems), head(list.head), count(list.count), cap(list.cap) {
+  list.elems = 0;
+  list.head = 0;
+  list.count = 0;
+  list.cap = 0;
+}
+
+/**
+ * Destructor
+ */
+template <class T> inline Deque<T>::~Deque() {
+  clear();
+  free(elems);
+}
+
+/**
+ * Return a reference to the item at index idx.
+ *
+ * @param idx The index (zero-based) of the item to return.
+ *
+ * @return The item at idx
+ */
+template <class T> inline T& Deque<T>::item(size_t idx) {
+  checkBounds(idx);
+  return Storage::get(*slot(idx));
+}
+
+/**
+ * Return a copy of the item at index idx.
+ *
+ * @param idx The index (zero-based) of the item to return.
+ *
+ * @return The item at idx
+ */
+template <class T> inline T Deque<T>::item(size_t idx) const {
+  checkBounds(idx);
+  return Storage::get(*slot(idx));
+}
+
+/**
+ * Construct a new item at the end of the deque, passing args to its
+ * constructor.
+ *
+ * @param args The constructor arguments.
+ */
+template <class T> template <class... Args>
+inline void Deque<T>::emplace(Args&&... args) {
+  place(false, std::forward<Args>(args)...);
+}
+
+/**
+ * Construct a new item at the beginning of the deque, passing args to
+ * its constructor.
+ *
+ * @param args The constructor arguments.
+ */
+template <class T> template <class... Args>
+inline void Deque<T>::emplaceFront(Args&&... args) {
+  place(true, std::forward<Args>(args)...);
+}
+
+/**
+ * Remove the last item from the deque.
+ *
+ * @return The removed item.
+ */
+template <class T> inline T Deque<T>::removeLast() {
+  checkBounds(count - 1);
+
+  Slot* last = slot(count - 1);
+  T t( std::move(Storage::get(*last)) );
+  Storage::destroy(last);
+  count--;
+
+  return t;
+}
+
+/**
+ * Remove the first item from the deque.
+ *
+ * @return The removed item.
+ */
+template <class T> inline T Deque<T>::removeFirst() {
+  checkBounds(0);
+
+  Slot* first = slot(0);
+  T t( std::move(Storage::get(*first)) );
+  Storage::destroy(first);
+  head = (head + 1) & (cap - 1);
+  count--;
+
+  return t;
+}
+
+/**
+ * Remove all items from the deque.
+ */
+template <class T> inline void Deque<T>::clear() {
+  while (count)
+    Storage::destroy(slot(--count));
+  head = 0;
+}
+
+/**
+ * Ensure the deque has room for at least capacity items (rounded up to
+ * a power of two), so that adding items up to that number will not
+ * move them.
+ *
+ * @param capacity The number of items to make room for.
+ */
+template <class T> inline void Deque<T>::reserve(size_t capacity) {
+  if (capacity > cap)
+    reallocate(roundCapacity(capacity));
+}
+
+/**
+ * Assignment operator.  Performs a deep copy of list into this deque.
+ *
+ * @param list  The deque to copy
+ *
+ * @return A reference to this deque
+ */
+template <class T> inline Deque<T>& Deque<T>::operator=(const Deque<T>& list) {
+  if (&list == this)
+    return *this;
+
+  clear();
+  reserve(list.count);
+
+  for (size_t i = 0; i < list.count; i++) {
+    Storage::construct(elems + i, Storage::get(*list.slot(i)));
+    count++;
+  }
+
+  return *this;
+}
+
+/**
+ * Move assignment operator.  Takes over the contents of list, which is
+ * left empty.
+ *
+ * @param list  The deque to move
+ *
+ * @return A reference to this deque
+ */
+template <class T> inline Deque<T>& Deque<T>::operator=(Deque<T>&& list) {
+  if (&list == this)
+    return *this;
+
+  // get rid of the current contents
+  clear();
+  free(elems);
+
+  // take over list's
+  elems = list.elems;
+  head = list.head;
+  count = list.count;
+  cap = list.cap;
+
+  list.elems = 0;
+  list.head = 0;
+  list.count = 0;
+  list.cap = 0;
+
+  return *this;
+}
+
+/**
+ * Equality operator.  Test all values of list to see if list is
+ * equal to this deque.
+ */
+template <class T> inline bool Deque<T>::operator==(const Deque<T>& list) const {
+  // don't bother if sizes aren't the same
+  if (count != list.count)
+    return false;
+
+  for (size_t i = 0; i < count; i++) {
+    if (Storage::get(*slot(i)) != Storage::get(*list.slot(i)))
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * Construct a new item at the beginning of the deque (if front is set)
+ * or at its end, passing args to its constructor.  The arguments may
+ * refer to an item already in the deque.
+ */
+template <class T> template <class... Args>
+inline void Deque<T>::place(bool front, Args&&... args) {
+  if (count < cap) {
+    if (front) {
+      Storage::construct(slot(cap - 1), std::forward<Args>(args)...);
+      head = (head + cap - 1) & (cap - 1);
+    } else {
+      Storage::construct(slot(count), std::forward<Args>(args)...);
+    }
+  } else {
+    // construct the item before moving any that the arguments refer to
+    typename std::aligned_storage<sizeof(Slot), alignof(Slot)>::type space;
+    Slot* t = reinterpret_cast<Slot*>(&space);
+    Storage::construct(t, std::forward<Args>(args)...);
+
+    try {
+      if (cap > (size_t)-1 / 2)
+        throw IntegerWrapException();
+      reallocate(cap ? cap * 2 : 16);
+    } catch (...) {
+      Storage::destroy(t);
+      throw;
+    }
+
+    // the items now begin at the start of the array
+    if (front) {
+      Storage::relocate(elems + cap - 1, t, 1);
+      head = cap - 1;
+    } else {
+      Storage::relocate(elems + count, t, 1);
+    }
+  }
+
+  count++;
+}
+
+/**
+ * Move the items, in order, to the start of a new array of newSize
+ * slots (a power of two no less than the number of items).
+ */
+template <class T> inline void Deque<T>::reallocate(size_t newSize) {
+  if (newSize > (size_t)-1 / sizeof(Slot))
+    throw IntegerWrapException();
+
+  Slot* newElems = static_cast<Slot*>(malloc(newSize * sizeof(Slot)));
+  if (!newElems)
+    throw OutOfMemoryException();
+
+  // the items may wrap around the end of the old array
+  size_t first = (count < cap - head) ? count : cap - head;
+  if (count) {
+    Storage::relocate(newElems, elems + head, first);
+    Storage::relocate(newElems + first, elems, count - first);
+  }
+  free(elems);
+
+  elems = newElems;
+  head = 0;
+  cap = newSize;
+}
+
+/**
+ * Return the smallest power of two no less than capacity (or 0).
+ */
+template <class T> inline size_t Deque<T>::roundCapacity(size_t capacity) {
+  if (!capacity)
+    return 0;
+
+  size_t rounded = 1;
+  while (rounded < capacity) {
+    if (rounded > (size_t)-1 / 2)
+      throw IntegerWrapException();
+    rounded <<= 1;
+  }
+
+  return rounded;
+}
+
+/**
+ * Ensures that pos is within the bounds of this deque.  An
+ * OutOfBoundsException is thrown otherwise.
+ */
+template <class T> inline void Deque<T>::checkBounds(size_t pos) const {
+  if (pos >= count)
+    throw OutOfBoundsException(0, count - 1, pos);
+}
+
+// Local Variables:
+// mode:C++
+// End:
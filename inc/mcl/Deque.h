@@ -0,0 +1,106 @@
+#ifndef _MCL_Deque_h_
+#define _MCL_Deque_h_
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <mcl/Vector.h>
+
+namespace mcl {
+
+/**
+ * Deque
+ *
+ * A double-ended queue.  Like a Vector, a deque is an array-backed
+ * list with fast access to items by index, and it has the same
+ * interface for the operations they share; but items are kept in a
+ * ring buffer, so adding and removing them at either end (push, pop,
+ * shift and unshift) takes constant time.  That makes it the better
+ * choice for a queue that items enter at one end and leave at the
+ * other.
+ *
+ * The capacity is always a power of two, and doubles when the deque is
+ * full.  Items are stored as a Vector of the same type would store
+ * them (see vector_stores_pointers).
+ */
+template <class T> class Deque {
+
+public:
+
+    inline Deque(int capacity = 16);
+    inline Deque(const Deque<T>& list);
+    inline Deque(Deque<T>&& list);
+    inline ~Deque();
+
+    // accessors
+    inline T& item(size_t idx);
+    inline T  item(size_t idx) const;
+    T& operator[](size_t idx)       { return item(idx); }
+    T  operator[](size_t idx) const { return item(idx); }
+    size_t size() const { return count; }
+    size_t capacity() const { return cap; }
+
+    // insertion
+    inline void append(const T& item)  { emplace(item); }
+    inline void append(T&& item)       { emplace(std::move(item)); }
+    inline void prepend(const T& item) { emplaceFront(item); }
+    inline void prepend(T&& item)      { emplaceFront(std::move(item)); }
+    inline void push(const T& item)    { emplace(item); }
+    inline void push(T&& item)         { emplace(std::move(item)); }
+    inline void unshift(const T& item) { emplaceFront(item); }
+    inline void unshift(T&& item)      { emplaceFront(std::move(item)); }
+
+    // construction in place
+    template <class... Args> inline void emplace(Args&&... args);
+    template <class... Args> inline void emplaceFront(Args&&... args);
+
+    // deletion
+    inline T removeLast();
+    inline T removeFirst();
+    inline T pop()   { return removeLast(); }
+    inline T shift() { return removeFirst(); }
+    inline void clear();
+
+    // capacity
+    inline void reserve(size_t capacity);
+
+    // other operators
+    inline Deque<T>& operator=(const Deque<T>& list);
+    inline Deque<T>& operator=(Deque<T>&& list);
+    inline bool operator==(const Deque<T>& list) const;
+    inline bool operator!=(const Deque<T>& list) const
+        { return (! (*this == list)); }
+
+protected:
+    typedef VectorStorage<T> Storage;
+    typedef typename Storage::Slot Slot;
+
+    inline void checkBounds(size_t pos) const;
+    inline Slot* slot(size_t idx) const { return elems + ((head + idx) & (cap - 1)); }
+    template <class... Args> inline void place(bool front, Args&&... args);
+    inline void reallocate(size_t newSize);
+    static inline size_t roundCapacity(size_t capacity);
+
+    /** The ring buffer of cap slots, where cap is a power of two */
+    Slot*  elems;
+    /** The position of the first item in elems */
+    size_t head;
+    size_t count;
+    size_t cap;
+};
+
+/**
+ * A Deque holds no pointers to itself, so it may be moved bitwise.
+ */
+template <class T> struct is_trivially_relocatable<Deque<T> > {
+    static const bool value = true;
+};
+
+#include "Deque.cpp"
+
+} // namespace
+
+#endif // _MCL_Deque_h_
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,212 @@
+#ifndef _MCL_Format_h_
+#define _MCL_Format_h_
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+/**
+ * Format
+ *
+ * A parsed printf-style format string.
+ */
+
+#include <mcl/String.h>
+
+namespace mcl {
+
+class StringBuilder;
+
+/**
+ * FormatArg holds one argument of String::format() along with its type,
+ * which is what decides how it may be converted.  Arguments are
+ * converted to a FormatArg implicitly, so there is rarely a need to
+ * create one directly.
+ */
+class FormatArg {
+
+public:
+
+  /** The kinds of value an argument may hold */
+  enum Type { NONE, INT, UINT, DOUBLE, CHAR, STRING };
+
+  FormatArg() : type(NONE), size(0) { }
+  FormatArg(char c) : type(CHAR), size(1) { value.c = c; }
+  FormatArg(signed char v)  { setInt(v, sizeof(v)); }
+  FormatArg(short v)        { setInt(v, sizeof(v)); }
+  FormatArg(int v)          { setInt(v, sizeof(v)); }
+  FormatArg(long v)         { setInt(v, sizeof(v)); }
+  FormatArg(long long v)    { setInt(v, sizeof(v)); }
+  FormatArg(unsigned char v)      { setUInt(v, sizeof(v)); }
+  FormatArg(unsigned short v)     { setUInt(v, sizeof(v)); }
+  FormatArg(unsigned int v)       { setUInt(v, sizeof(v)); }
+  FormatArg(unsigned long v)      { setUInt(v, sizeof(v)); }
+  FormatArg(unsigned long long v) { setUInt(v, sizeof(v)); }
+  FormatArg(double v) : type(DOUBLE), size(sizeof(v)) { value.d = v; }
+  FormatArg(const char* str);
+  FormatArg(const String& str) : type(STRING), size(0)
+    { value.s.data = str.data(); value.s.len = str.size(); }
+
+  /** The kind of value held */
+  Type type;
+  /** The size in bytes of the original integer type */
+  unsigned size;
+  /** The value */
+  union {
+    long long i;
+    unsigned long long u;
+    double d;
+    char c;
+    struct {
+      const char* data;
+      size_t len;
+    } s;
+  } value;
+
+protected:
+  void setInt(long long v, unsigned bytes)
+    { type = INT; size = bytes; value.i = v; }
+  void setUInt(unsigned long long v, unsigned bytes)
+    { type = UINT; size = bytes; value.u = v; }
+};
+
+/**
+ * Format is a printf-style format string parsed into the literal text
+ * and conversions it consists of, so that it can be applied to any
+ * number of argument lists without being parsed again.
+ *
+ * <code>
+ * static const Format line("%-10s %6.2f %5d\n");
+ *
+ * String row = String::format(line, name, price, quantity);
+ * </code>
+ *
+ * String::format() may also be given the format string itself, in which
+ * case the parsed form is looked up in a small per-thread cache keyed by
+ * the address of the string (and parsed only if it is not found).  A
+ * String is never converted to a Format implicitly, which would parse
+ * it on every call; to use the cache for one, pass
+ * Format::cached(str.terminated().data()).
+ *
+ * A conversion has the form %[flags][width][.precision][length]type,
+ * where the flags are any of "-+ 0#" as for printf.  The length
+ * modifiers (h, l, ll, z, and so on) are accepted, but only h and hh
+ * have an effect: as in printf, they narrow a negative value written in
+ * hexadecimal or octal to a short or a char.  Otherwise the type of each
+ * argument is known, and a negative value is written as the unsigned
+ * value of its type, or of int if that is smaller (so a char of -1
+ * gives "ffffffff", as printf would).  Unlike printf, the arguments are
+ * type-checked: a FormatException is thrown if one does not suit its
+ * conversion, or if there are too few or too many arguments.
+ *
+ *   %d %i %u      An integer (or char) in decimal
+ *   %x %X %o      An integer in hexadecimal or octal
+ *   %c            A char, or an integer character code
+ *   %f %e %g ...  A double (or integer) as printf would write it
+ *   %s            Any argument in its natural form: a String or C
+ *                 string as it is, a number in decimal (a double with
+ *                 the shortest digits that represent it exactly, as
+ *                 String::fromDouble() does), and a char as a character
+ *   %%            A percent sign
+ */
+class Format {
+
+public:
+
+  explicit Format(const char* format);
+  explicit Format(const String& format);
+  ~Format();
+
+  // accessors
+  const String& source() const { return text; }
+  size_t arguments() const { return count; }
+
+  // formatting
+  String apply(const FormatArg* args, size_t n) const;
+  void append(StringBuilder& b, const FormatArg* args, size_t n) const;
+
+  /** Return the parsed form of format from the cache of the current thread */
+  static const Format& cached(const char* format);
+
+protected:
+  // not copyable
+  Format(const Format&);
+  Format& operator=(const Format&);
+
+  void parse();
+
+  struct Spec;
+  static void convert(StringBuilder& b, const Spec& spec,
+                      const FormatArg& arg);
+  static void appendInteger(StringBuilder& b, const Spec& spec,
+                            const FormatArg& arg);
+  static void appendDouble(StringBuilder& b, const Spec& spec, double value);
+  static void appendPadded(StringBuilder& b, const Spec& spec,
+                           const char* str, size_t len);
+
+  /** Conversion flags */
+  enum {
+    LEFT      = 1,
+    PLUS      = 2,
+    SPACE     = 4,
+    ZERO      = 8,
+    ALTERNATE = 16
+  };
+
+  /** A conversion, and the literal text that precedes it */
+  struct Spec {
+    /** The end of the literal text in literals (which begins at the
+        end of the previous one) */
+    size_t literalEnd;
+    /** The conversion character, or 0 for the text after the last one */
+    char type;
+    unsigned char flags;
+    /** The width and precision, or -1 if not given */
+    int width;
+    int precision;
+    /** The size in bytes given by an h or hh modifier, or 0 */
+    unsigned char length;
+  };
+
+  /** The format string */
+  String text;
+  /** The literal text of the format string, with "%%" replaced by "%" */
+  char* literals;
+  /** The conversions, ending with one of type 0 */
+  Spec* specs;
+  /** The number of arguments expected */
+  size_t count;
+};
+
+
+/**
+ * Return a String formatted from args according to fmt, as described
+ * for Format.
+ *
+ * @param fmt  The parsed format.
+ * @param args The values to format.
+ */
+template <typename... Args>
+String String::format(const Format& fmt, const Args&... args) {
+  const FormatArg list[] = { FormatArg(args)..., FormatArg() };
+  return fmt.apply(list, sizeof...(Args));
+}
+
+/**
+ * Return a String formatted from args according to the printf-style
+ * format string fmt (see Format).  The parsed form of fmt is cached by
+ * the thread, so that a format string used repeatedly is parsed once.
+ *
+ * @param fmt  The format string.
+ * @param args The values to format.
+ */
+template <typename... Args>
+String String::format(const char* fmt, const Args&... args) {
+  return format(Format::cached(fmt), args...);
+}
+
+} // namespace
+
+#endif // _MCL_Format_h_
+
+// Local Variables:
+// mode:C++
+// End:
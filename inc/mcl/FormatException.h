@@ -0,0 +1,36 @@
+#ifndef _MCL_FormatException_h_
+#define _MCL_FormatException_h_
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <mcl/Exception.h>
+#include <mcl/error_messages.h>
+
+namespace mcl {
+  
+/**
+ * FormatException indicates a format string that cannot be parsed, or
+ * one that does not match the arguments it is applied to (such as "%d"
+ * given a String, or a missing argument).
+ */
+class FormatException : public Exception {
+
+public:
+  
+  /** Contructor */
+  FormatException() { }
+  
+  /** Return the message associated with this exception */
+  const char* message() const { return _MCL_ERR_FORMAT_; }
+
+};
+
+} // namespace
+
+
+#endif // _MCL_FormatException_h_
+
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,41 @@
+#ifndef _MCL_IOException_h_
+#define _MCL_IOException_h_
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <mcl/Exception.h>
+#include <mcl/error_messages.h>
+
+namespace mcl {
+  
+/**
+ * IOException indicates a failure reading or writing a file (such as
+ * attempting to open a file that does not exist).
+ */
+class IOException : public Exception {
+
+public:
+  
+  /** Contructor */
+  IOException(int code) : errorCode(code) { }
+  
+  /** Return the message associated with this exception */
+  const char* message() const { return _MCL_ERR_IO_; }
+
+  /** Return the system error number (errno) describing the failure */
+  int code() const { return errorCode; }
+
+protected:
+  int errorCode;
+  
+};
+
+} // namespace
+
+
+#endif // _MCL_IOException_h_
+
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,36 @@
+#ifndef _MCL_NumberFormatException_h_
+#define _MCL_NumberFormatException_h_
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <mcl/Exception.h>
+#include <mcl/error_messages.h>
+
+namespace mcl {
+  
+/**
+ * NumberFormatException indicates an attempt to convert a string that
+ * does not hold a number of the expected form (such as converting
+ * "12a" to an integer).
+ */
+class NumberFormatException : public Exception {
+
+public:
+  
+  /** Contructor */
+  NumberFormatException() { }
+  
+  /** Return the message associated with this exception */
+  const char* message() const { return _MCL_ERR_NUMBER_FORMAT_; }
+
+};
+
+} // namespace
+
+
+#endif // _MCL_NumberFormatException_h_
+
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,174 @@
+#ifndef _MCL_Rope_h_
+#define _MCL_Rope_h_
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+/**
+ * Rope
+ *
+ * An immutable string made of shared pieces, for very large strings.
+ */
+
+#include <mcl/String.h>
+#include <mcl/Atomic.h>
+
+namespace mcl {
+
+/**
+ * Rope is an immutable string represented as a balanced tree whose
+ * leaves are Strings.  Where a String must copy all of its data to
+ * produce a modified version, a Rope builds the new version from the
+ * pieces of the old ones: concatenation, substrings, insertion and
+ * removal take O(log n) time however long the text is, and the
+ * versions share their leaves (and the StringRefs behind them).
+ * Accessing a single character also takes O(log n) time, so a Rope is
+ * only worthwhile for long text that is edited or assembled from large
+ * pieces.  flatten() produces an ordinary String from a Rope, and
+ * Rope::Iterator visits its characters or pieces in order.
+ *
+ * The tree is kept balanced in the manner of an AVL tree (the heights
+ * of the two halves of any node differ by at most one), so its depth
+ * is always logarithmic in the number of leaves.  Small adjacent
+ * leaves are combined as they are concatenated.
+ *
+ * Like a String, a Rope may be copied freely, and copies may be used by
+ * multiple threads at once.
+ */
+class Rope {
+
+public:
+
+  /** Concatenations at most this long are combined into one leaf */
+  enum { LEAF_MERGE = 64 };
+
+  // constructors
+  Rope() : root(0) { }
+  Rope(const String& str);
+  Rope(const char* str);
+  Rope(const Rope& rope);
+  Rope(Rope&& rope) : root(rope.root) { rope.root = 0; }
+
+  // destructor
+  ~Rope();
+
+  // accessors
+  inline size_t size() const;
+  inline int depth() const;
+  char charAt(size_t pos) const;
+
+  // new versions
+  Rope concat(const Rope& rope) const;
+  Rope operator+(const Rope& rope) const { return concat(rope); }
+  Rope substring(long offset) const;
+  Rope substring(long offset, long len) const;
+  Rope insert(size_t pos, const Rope& rope) const;
+  Rope remove(long offset, long len) const;
+
+  // conversion
+  String flatten() const;
+
+  // assignment operations
+  Rope& operator=(const Rope& rope);
+  Rope& operator=(Rope&& rope);
+
+  class Iterator;
+
+protected:
+  /** A node of the tree: a leaf (height 0) or a concatenation */
+  struct Node {
+    Atomic<int> refCount;
+    size_t size;
+    int height;
+    Node* left;
+    Node* right;
+    String str;
+  };
+
+  /** Construct a Rope from a tree it takes over the reference to */
+  explicit Rope(Node* root) : root(root) { }
+
+  static Node* leaf(const String& str);
+  static Node* node(Node* left, Node* right);
+  static Node* join(Node* left, Node* right);
+  static Node* joinBalanced(Node* left, Node* right);
+  static Node* range(Node* n, size_t from, size_t to);
+  static int height(const Node* n) { return n ? n->height : -1; }
+  static inline Node* retain(Node* n);
+  static void release(Node* n);
+
+  Node* root;
+};
+
+/**
+ * Rope::Iterator visits the contents of a Rope in order, either one
+ * character at a time or one leaf at a time.  The iterator keeps its
+ * own copy of the Rope.
+ *
+ * <code>
+ * Rope::Iterator it(rope);
+ * String piece;
+ *
+ * while (it.next(piece))
+ *   fwrite(piece.data(), 1, piece.size(), out);
+ * </code>
+ */
+class Rope::Iterator {
+
+public:
+
+  Iterator(const Rope& rope);
+
+  // iteration
+  bool hasNext() const { return pos < chunk.size() || top > 0; }
+  char nextChar();
+  bool next(String& piece);
+
+protected:
+  /** Enough for a balanced tree of any size that fits in memory */
+  enum { MAX_DEPTH = 96 };
+
+  void advance();
+
+  /** The rope being visited */
+  Rope rope;
+  /** The subtrees yet to be visited, the next one last */
+  const Node* stack[MAX_DEPTH];
+  /** The number of nodes in stack */
+  int top;
+  /** The leaf being visited */
+  String chunk;
+  /** The position of the next character in chunk */
+  size_t pos;
+};
+
+/**
+ * Return the number of characters in this Rope.
+ */
+inline size_t Rope::size() const {
+  return root ? root->size : 0;
+}
+
+/**
+ * Return the height of the tree representing this Rope (0 for a single
+ * leaf or an empty Rope).
+ */
+inline int Rope::depth() const {
+  return root ? root->height : 0;
+}
+
+/**
+ * Add a reference to n (if it is not null), returning it.
+ */
+inline Rope::Node* Rope::retain(Node* n) {
+  if (n)
+    n->refCount.fetchAdd(1, MEMORY_RELAXED);
+  return n;
+}
+
+} // namespace
+
+#endif // _MCL_Rope_h_
+
+// Local Variables:
+// mode:C++
+// End:
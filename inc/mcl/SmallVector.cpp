@@ -0,0 +1,134 @@
+/**
+ * Default constructor.  The list starts with its own N slots.
+ */
+template <class T, size_t N> inline SmallVector<T, N>::SmallVector()
+  : Vector<T>(inlineSlots(), N) {
+  static_assert(N > 0, "a SmallVector needs room for at least one item");
+}
+
+/**
+ * Copy constructor.  Performs a deep copy of list, on the heap only if
+ * it has more than N items.
+ *
+ * @param list The vector to copy
+ */
+template <class T, size_t N>
+inline SmallVector<T, N>::SmallVector(const SmallVector<T, N>& list)
+  : Vector<T>(inlineSlots(), N) {
+  Vector<T>::operator=(list);
+}
+
+/**
+ * Copy constructor.  Performs a deep copy of list, on the heap only if
+ * it has more than N items.
+ *
+ * @param list The vector to copy
+ */
+template <class T, size_t N>
+inline SmallVector<T, N>::SmallVector(const Vector<T>& list)
+  : Vector<T>(inlineSlots(), N) {
+  Vector<T>::operator=(list);
+}
+
+/**
+ * Move constructor.  Takes over list's array if it is on the heap, and
+ * moves its items otherwise.  The list is left empty.
+ *
+ * @param list The vector to move
+ */
+template <class T, size_t N>
+inline SmallVector<T, N>::SmallVector(SmallVector<T, N>&& list)
+  : Vector<T>(inlineSlots(), N) {
+  Vector<T>::operator=(std::move(list));
+  list.restoreInline();
+}
+
+/**
+ * Move constructor.  Takes over list's array if it is on the heap, and
+ * moves its items otherwise.  The list is left empty.
+ *
+ * @param list The vector to move
+ */
+template <class T, size_t N>
+inline SmallVector<T, N>::SmallVector(Vector<T>&& list)
+  : Vector<T>(inlineSlots(), N) {
+  Vector<T>::operator=(std::move(list));
+}
+
+/**
+ * Destructor.  The items are destroyed here, while the slots that may
+ * hold them still exist.
+ */
+template <class T, size_t N> inline SmallVector<T, N>::~SmallVector() {
+  this->clear();
+}
+
+/**
+ * Assignment operator.  Performs a deep copy of list into this list.
+ *
+ * @param list  The list to copy
+ *
+ * @return A reference to this list
+ */
+template <class T, size_t N> inline SmallVector<T, N>&
+SmallVector<T, N>::operator=(const SmallVector<T, N>& list) {
+  Vector<T>::operator=(list);
+  return *this;
+}
+
+/**
+ * Assignment operator.  Performs a deep copy of list into this list.
+ *
+ * @param list  The list to copy
+ *
+ * @return A reference to this list
+ */
+template <class T, size_t N> inline SmallVector<T, N>&
+SmallVector<T, N>::operator=(const Vector<T>& list) {
+  Vector<T>::operator=(list);
+  return *this;
+}
+
+/**
+ * Move assignment operator.  Takes over the contents of list, which is
+ * left empty.
+ *
+ * @param list  The list to move
+ *
+ * @return A reference to this list
+ */
+template <class T, size_t N> inline SmallVector<T, N>&
+SmallVector<T, N>::operator=(SmallVector<T, N>&& list) {
+  Vector<T>::operator=(std::move(list));
+  list.restoreInline();
+  return *this;
+}
+
+/**
+ * Move assignment operator.  Takes over the contents of list, which is
+ * left empty.
+ *
+ * @param list  The list to move
+ *
+ * @return A reference to this list
+ */
+template <class T, size_t N> inline SmallVector<T, N>&
+SmallVector<T, N>::operator=(Vector<T>&& list) {
+  Vector<T>::operator=(std::move(list));
+  return *this;
+}
+
+/**
+ * Return to the list's own slots if its heap array was taken by a move.
+ */
+template <class T, size_t N> inline void SmallVector<T, N>::restoreInline() {
+  if (!this->local && !this->elems) {
+    this->elems = inlineSlots();
+    this->cap = N;
+    this->local = true;
+  }
+}
+
+// Local Variables:
+// mode:C++
+// End:
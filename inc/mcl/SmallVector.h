@@ -0,0 +1,63 @@
+#ifndef _MCL_SmallVector_h_
+#define _MCL_SmallVector_h_
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <mcl/Vector.h>
+
+namespace mcl {
+
+/**
+ * SmallVector
+ *
+ * A Vector with room for its first N items in the object itself, so
+ * that a short list needs no allocation at all.  Only when more than N
+ * items are added are they moved to an array on the heap, which then
+ * grows as a Vector's does.  (If T is stored by pointer, see
+ * vector_stores_pointers, the object holds the array of pointers, and
+ * each item is still allocated separately.)
+ *
+ * A SmallVector is a Vector, and may be used, passed and assigned
+ * wherever one is expected.  Unlike a Vector it is not trivially
+ * relocatable, since its array may be part of it.
+ */
+template <class T, size_t N> class SmallVector : public Vector<T> {
+
+public:
+
+    inline SmallVector();
+    inline SmallVector(const SmallVector<T, N>& list);
+    inline SmallVector(const Vector<T>& list);
+    inline SmallVector(SmallVector<T, N>&& list);
+    inline SmallVector(Vector<T>&& list);
+    inline ~SmallVector();
+
+    /** Return true if the items are in the object and not on the heap */
+    bool isInline() const { return this->local; }
+
+    // assignment
+    inline SmallVector<T, N>& operator=(const SmallVector<T, N>& list);
+    inline SmallVector<T, N>& operator=(const Vector<T>& list);
+    inline SmallVector<T, N>& operator=(SmallVector<T, N>&& list);
+    inline SmallVector<T, N>& operator=(Vector<T>&& list);
+
+protected:
+    typedef typename Vector<T>::Slot Slot;
+
+    inline Slot* inlineSlots()
+        { return reinterpret_cast<Slot*>(&buffer); }
+    inline void restoreInline();
+
+    /** The first N slots */
+    typename std::aligned_storage<sizeof(Slot) * N, alignof(Slot)>::type buffer;
+};
+
+#include "SmallVector.cpp"
+
+} // namespace
+
+#endif // _MCL_SmallVector_h_
+
+// Local Variables:
+// mode:C++
+// End:
@@ -9,48 +9,191 @@
  * An immutable string class implementation.
  */
 
+#include <mcl/config.h>
 #include <mcl/OutOfBoundsException.h>
+#include <mcl/OutOfMemoryException.h>
 #include <mcl/Atomic.h>
+#include <mcl/memory_functions.h>
+#include <mcl/StringAllocator.h>
+#include <mcl/StringArena.h>
+#include <mcl/type_traits.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <utility>
 
 namespace mcl {
 
+template <class T> class Vector;
+class Format;
+class StringRefOwner;
+
 /**
  * StringRef is a sharable reference to a block of data. The String
  * class uses it to allow multiple instances to reference the same
  * string of data.  When StringRef goes out of scope, any data it
  * references is deleted also.
+ *
+ * Ordinarily a StringRef is allocated with create(), which places the
+ * header and the character data in a single block of memory (the data
+ * immediately follows the header) obtained from the current
+ * StringAllocator.  This halves the number of allocations needed for a
+ * String.  On 64-bit systems the header is larger than a cache line,
+ * so the data does not share a line with the reference count; the
+ * fields used on every access (the count, size and data pointer) come
+ * first.  A StringRef may also be constructed directly to refer to a
+ * separate block of data, which its deleter frees once the last
+ * reference is gone.  Without a deleter the data is constant (frozen)
+ * and never freed.  Data that is not allocated by create() is not
+ * necessarily null-terminated; terminated records whether it is.
+ *
+ * An immortal StringRef is never freed, so its reference count is
+ * never changed either.  Strings sharing it are copied and destroyed
+ * without any atomic operations, which keeps a widely shared value from
+ * bouncing a cache line between processors (see String::makeImmortal()).
+ *
+ * A StringRef created by a thread that uses biased reference counting
+ * (see String::useBiasedReferences()) is owned by that thread.  The
+ * owner counts its references in biasedCount without atomic
+ * operations, and other threads count theirs in refCount, which then
+ * also holds the BIAS_QUEUED and BIAS_MERGED flags in its low bits.
  */
 class StringRef {
 
 public:
 
+  /**
+   * A function releasing size bytes of data no longer referenced by a
+   * StringRef (see String::String(char*, size_t, Deleter, void*, bool)).
+   * context is the value supplied along with the function.
+   */
+  typedef void (*Deleter)(char* data, size_t size, void* context);
+
   /** The reference count. */
-  int refCount;
+  Atomic<int> refCount;
+
+  /** The identifier of the StringPool the data is interned in, or 0. */
+  int pool;
 
   /** The size of data. */
   size_t size;
-  
+
   /** The referenced data. */
   char* data;
 
-  /** When set, data will never be deleted (useful for constants) */
-  bool dataFrozen;
+  /**
+   * The room for data following the header (see create()).  It may be
+   * more than size, and is what determines the size of the block.
+   */
+  size_t capacity;
+
+  /**
+   * The hash value of data, or 0 if it has not been computed yet.  It
+   * is computed on demand by String::hash(); since every thread that
+   * computes it stores the same value, it is read and written with
+   * relaxed ordering and needs no locking.
+   */
+  Atomic<size_t> hashCode;
+
+  /** Frees data when the reference is destroyed, or 0 if data is frozen */
+  Deleter deleter;
+
+  /** The value passed to deleter */
+  void* deleterContext;
+
+  /** Set if the byte following data is known to be a null character */
+  bool terminated;
+
+  /** Set if data follows the header in the same block (see create()) */
+  bool embedded;
+
+  /** When set, the reference is never counted or freed */
+  Atomic<bool> immortal;
+
+  /** The references held by the owner thread, if there is one */
+  int biasedCount;
 
-  /** Constructor for a data block (automatcially deleted by destructor). */
-  StringRef(size_t size, char* data, bool dataFrozen = false)
-    : refCount(1), size(size), data(data), dataFrozen(dataFrozen) { }
+  /** The owner (biased reference counting only), or 0 */
+  StringRefOwner* owner;
+
+  /** The allocator of this StringRef, or 0 if it was allocated by new */
+  StringAllocator* allocator;
+
+  /** Flags and unit of refCount when there is an owner */
+  enum { BIAS_QUEUED = 1, BIAS_MERGED = 2, BIAS_UNIT = 4 };
+
+  /** The owner of references created by the current thread, or 0 */
+  static _MCL_THREAD_LOCAL StringRefOwner* currentOwner;
+
+  /** Constructor for a data block (released by deleter when destroyed). */
+  StringRef(size_t size, char* data, Deleter deleter = deleteArray,
+            void* deleterContext = 0, bool terminated = true,
+            bool immortal = false)
+    : refCount(1), pool(0), size(size), data(data), capacity(0), hashCode(0),
+      deleter(deleter), deleterContext(deleterContext),
+      terminated(terminated), embedded(false), immortal(immortal),
+      biasedCount(0), owner(0), allocator(0)
+    { }
 
   /** Destructor */
-  ~StringRef() { if (data && !dataFrozen) delete [] data; }
+  ~StringRef()
+    { if (data && deleter && !embedded) deleter(data, size, deleterContext); }
+
+  /** A Deleter for data allocated with new [] */
+  static void deleteArray(char* data, size_t, void*)
+    { delete [] data; }
+
+  /** Allocate a StringRef with room for size bytes of data following it. */
+  static inline StringRef* create(size_t size, bool biased = true);
+
+  /** Allocate a StringRef taking over data that deleter releases. */
+  static StringRef* adopt(char* data, size_t size, Deleter deleter,
+                          void* deleterContext, bool terminated);
+
+  /** Change the room for data in a StringRef allocated by create(). */
+  static inline StringRef* resize(StringRef* ref, size_t size);
+
+  /** Free a StringRef, whether it was allocated by create() or new. */
+  static inline void destroy(StringRef* ref);
+
+ protected:
+  /** Return the address of the data area following the header. */
+  char* buffer() { return reinterpret_cast<char*>(this + 1); }
+
+  /** Return the size of the block allocated for this StringRef. */
+  size_t blockSize()
+    { return sizeof(StringRef) + (embedded ? capacity + 1 : 0); }
+};
+
+/**
+ * The StringRef shared by every String whose data is in a StringArena.
+ * It is immortal, so such Strings are never reference counted, and it
+ * refers to no data of its own.
+ */
+extern StringRef ARENA_STRING;
+
+/**
+ * StringRefOwner is the state a thread using biased reference counting
+ * shares with other threads.  Only the flag needed on the owner's fast
+ * path is declared here.
+ */
+class StringRefOwner {
+
+public:
+
+  /** Set when references released by other threads await merging */
+  Atomic<bool> pending;
 };
 
 /**
  * String is an immutable string.  String is intended as an
  * object-oriented version of a C null-terminated string.  It is
  * designed to be as interoperable as possible with ordinary C
- * strings.  The data in a String is always null-terminated, however
- * it also contains the size of the string, so it may be used to hold
- * "strings" (really any block of data) with embedded nulls.
+ * strings.  The data in a String is always null-terminated (with the
+ * exception of slices, see slice()), however it also contains the size
+ * of the string, so it may be used to hold "strings" (really any block
+ * of data) with embedded nulls.
  *
  * Multiple instances of a String may point to the same data.  This
  * allows for efficient copying and assigning of a String.  Because
@@ -104,6 +247,30 @@ public:
  * (which can be shared by many other string instances) and that data is
  * automatically freed when the last String instance that uses it goes
  * out of scope.
+ *
+ * Short strings (up to LOCAL_CAPACITY bytes, 22 on a 64-bit system) are
+ * stored directly inside the String instance instead of in a shared
+ * StringRef.  Creating, copying and destroying such a string requires
+ * no memory allocation and no atomic reference counting.  Longer
+ * strings share a StringRef as described above.  The choice is made
+ * internally and has no effect on how a String is used.
+ *
+ * A String may also refer directly to data that never changes, such as
+ * a string literal, without a StringRef (see literal()).  Such a
+ * string is never reference counted, so creating, copying and
+ * destroying it costs no more than for a local string whatever its
+ * length.  The _str suffix creates one from a literal:
+ *
+ * <code>
+ * using namespace mcl::literals;
+ *
+ * String key = "Content-Type"_str;
+ * </code>
+ *
+ * Strings created while a StringArena is active take their data from
+ * the arena, which frees it all at once, and are not reference counted
+ * either.  promote() copies such a String out of the arena when it must
+ * outlive it.
  */
 class String {
 
@@ -112,26 +279,40 @@ public:
   // constructors
   String();
   String (const String& str);
+  inline String (String&& str);
   String (const String& str, long offset);
   String (const String& str, long offset, long len);
   String (const char* str);
   String (const char* str, size_t len);
   String (char c, size_t repeat = 1);
+  String (char* data, size_t len, StringRef::Deleter deleter,
+          void* context = 0, bool terminated = false);
+  static inline String literal(const char* str, size_t len);
+  static String fromFile(const char* path);
+  static String fromInt(long long value);
+  static String fromUInt(unsigned long long value);
+  static String fromDouble(double value);
+  template <typename... Args>
+  static String format(const Format& fmt, const Args&... args);
+  template <typename... Args>
+  static String format(const char* fmt, const Args&... args);
 
   // destructor
   ~String();
 
   // accessors
-  const char* data() const     { return ref->data; }
-  operator const char*() const { return ref->data; }
-  size_t size() const          { return ref->size; }
+  const char* data() const
+    { return isLocal() ? rep.local + LOCAL_POS : rep.shared.ptr; }
+  operator const char*() const { return data(); }
+  size_t size() const
+    { return isLocal() ? (size_t)(tag() & ~LOCAL_FLAG) : rep.shared.len; }
 
   // hashing
   static size_t hash(const String& str);
 
   // character accessors
   char charAt(size_t pos) const
-    { checkBounds(pos); return ref->data[pos]; }
+    { checkBounds(pos); return data()[pos]; }
   /* uses operator const char* -- dumb
   char operator[](size_t pos) const
     { checkBounds(pos); return m_ref->m_data[pos]; }
@@ -141,10 +322,54 @@ public:
   String substring(long offset) const;
   String substring(long offset, long len) const;
 
+  // slices (substrings that always share data)
+  String slice(long offset, long len) const;
+  inline bool isTerminated() const;
+  String terminated() const;
+  void compact();
+  void makeImmortal();
+
+  // numeric conversion
+  long long toInt64() const;
+  unsigned long long toUInt64() const;
+  double toDouble() const;
+
+  // arenas
+  bool inArena() const
+    { return !isLocal() && rep.shared.ref == &ARENA_STRING; }
+  void promote();
+
+  // reference counting
+  static void useBiasedReferences(bool enable);
+  static bool usesBiasedReferences() { return StringRef::currentOwner != 0; }
+
+  // searching
+  long find(char c, long from = 0) const;
+  long find(const String& str, long from = 0) const;
+  long rfind(char c) const;
+  long rfind(const String& str) const;
+  bool contains(char c) const            { return find(c) >= 0; }
+  bool contains(const String& str) const { return find(str) >= 0; }
+  bool startsWith(const String& str) const;
+  bool endsWith(const String& str) const;
+  size_t count(char c) const;
+  size_t count(const String& str) const;
+
+  // splitting
+  size_t split(char delim, Vector<String>& fields) const;
+  size_t split(const String& delim, Vector<String>& fields) const;
+  template <class Function> size_t split(char delim, Function each) const
+    { return splitFields(&delim, 1, each); }
+  template <class Function>
+    size_t split(const String& delim, Function each) const
+    { return splitFields(delim.data(), delim.size(), each); }
+
   // assignment operations
   String& operator=(const String& str) { assign(str); return *this; }
+  String& operator=(String&& str)      { assign(std::move(str)); return *this; }
   String& operator=(const char* str)    { assign(str); return *this; }
   void assign(const String& str);
+  inline void assign(String&& str);
   void assign(const char* str);
   void assign(const String& str, long offset)
     { assign(str, offset, (offset < 0 ? 0 - offset : str.size() + offset)); }
@@ -153,13 +378,14 @@ public:
   void assign(char c, size_t repeat = 1);
   
   // comparison routines
-  bool operator==(const String& str) const { return (compare(str) == 0); }
-  bool operator!=(const String& str) const { return (compare(str) != 0); }
+  bool operator==(const String& str) const { return equals(str); }
+  bool operator!=(const String& str) const { return !equals(str); }
   bool operator<(const String& str)  const { return (compare(str) < 0); }
   bool operator>(const String& str)  const { return (compare(str) > 0); }
   bool operator<=(const String& str)  const { return (compare(str) <= 0); }
   bool operator>=(const String& str)  const { return (compare(str) >= 0); }
   int compare(const String& str) const;
+  inline bool equals(const String& str) const;
 
   bool operator==(const char* str) const { return (compare(str) == 0); }
   bool operator!=(const char* str) const { return (compare(str) != 0); }
@@ -168,35 +394,357 @@ public:
   bool operator<=(const char* str)  const { return (compare(str) <= 0); }
   bool operator>=(const char* str)  const { return (compare(str) >= 0); }
   int compare(const char* str) const;
+  int compare(const char* str, size_t len) const;
+
+ protected:
+  friend class Rope;
+  friend class StringBuilder;
+  friend class StringPool;
+  friend class StringTokenizer;
+
+  /**
+   * The representation of a string held in a StringRef.  The members
+   * are ordered so that the most significant byte of len overlaps the
+   * tag byte of the local representation.  A string size never uses
+   * the high bit of that byte, which is what distinguishes the two.
+   */
+#ifdef _MCL_BIG_ENDIAN
+  struct SharedRep { size_t len; StringRef* ref; const char* ptr; };
+  enum { TAG_POS = 0, LOCAL_POS = 1 };
+#else
+  struct SharedRep { StringRef* ref; const char* ptr; size_t len; };
+  enum { TAG_POS = sizeof(SharedRep) - 1, LOCAL_POS = 0 };
+#endif
+
+ public:
+  /** The longest string that is stored without a StringRef. */
+  enum { LOCAL_CAPACITY = sizeof(SharedRep) - 2 };
 
  protected:
+  enum { LOCAL_FLAG = 0x80 };
+
+  unsigned char tag() const
+    { return reinterpret_cast<const unsigned char*>(&rep)[TAG_POS]; }
+  bool isLocal() const { return (tag() & LOCAL_FLAG) != 0; }
+  bool isCounted() const { return !isLocal() && rep.shared.ref; }
+  inline bool isTerminatedAt(size_t pos) const;
+  inline void setLocal(const char* str, size_t len);
+  inline char* setLocal(size_t len);
+  inline void setShared(StringRef* ref);
+  inline void setArena(const char* ptr, size_t len);
+  char* allocate(size_t len);
+  void assignSlice(const String& str, size_t offset, size_t len,
+                   bool terminated);
+  static void constrain(long strSize, long& offset, long& len);
+  template <class Function>
+    size_t splitFields(const char* delim, size_t delimLen,
+                       Function& each) const;
+
   inline void checkBounds(size_t pos) const;
   inline bool acquireReference(StringRef* ref);
   inline bool releaseReference(StringRef* ref);
+  static bool releaseBiased(StringRef* ref);
+  static bool releaseShared(StringRef* ref);
+  static void mergeQueued();
   void release();
 
-  StringRef* ref;
+  union {
+    SharedRep shared;
+    char      local[sizeof(SharedRep)];
+  } rep;
+};
+
+/**
+ * A String never points to itself, so it may be moved bitwise, which
+ * saves adjusting the reference count of its data.
+ */
+template <> struct is_trivially_relocatable<String> {
+  static const bool value = true;
 };
 
+/**
+ * Allocate a new StringRef and the storage for size bytes of data as
+ * one block.  The data is null-terminated at size, but is otherwise
+ * uninitialized.  The new reference has a count of one.  Unless biased
+ * is cleared, it is owned by the current thread if that thread uses
+ * biased reference counting.
+ */
+inline StringRef* StringRef::create(size_t size, bool biased) {
+  StringAllocator* allocator = StringAllocator::current();
+  void* block = allocator->allocate(sizeof(StringRef) + size + 1);
+  if (!block)
+    throw OutOfMemoryException();
+
+  StringRef* ref = new (block) StringRef(size, 0);
+  ref->allocator = allocator;
+  ref->embedded = true;
+  ref->capacity = size;
+  ref->data = ref->buffer();
+  ref->data[size] = 0;
+
+  if (biased && currentOwner) {
+    ref->owner = currentOwner;
+    ref->biasedCount = 1;
+    ref->refCount.store(0, MEMORY_RELAXED);
+  }
+
+  return ref;
+}
+
+/**
+ * Reallocate a StringRef allocated by create() with room for size bytes
+ * of data, which is null-terminated at size.  The data it already
+ * holds is preserved (up to the new size).  The reference may move, so
+ * it must not yet be shared; the new address is returned.
+ */
+inline StringRef* StringRef::resize(StringRef* ref, size_t size) {
+  void* block = ref->allocator->reallocate(ref, ref->blockSize(),
+                                           sizeof(StringRef) + size + 1);
+  if (!block)
+    throw OutOfMemoryException();
+
+  ref = static_cast<StringRef*>(block);
+  ref->size = size;
+  ref->capacity = size;
+  ref->data = ref->buffer();
+  ref->data[size] = 0;
+
+  return ref;
+}
+
+/**
+ * Free a StringRef that is no longer referenced.
+ */
+inline void StringRef::destroy(StringRef* ref) {
+  StringAllocator* allocator = ref->allocator;
+  if (!allocator) {
+    delete ref;
+    return;
+  }
+
+  size_t bytes = ref->blockSize();
+  ref->~StringRef();
+  allocator->deallocate(ref, bytes);
+}
+
+/**
+ * Construct a String by taking over the data of str, which is left
+ * empty.  No reference counting is needed.
+ *
+ * @param str The string to move.
+ */
+inline String::String(String&& str) : rep(str.rep) {
+  str.setLocal((size_t)0);
+}
+
+/**
+ * Return a String referring to the len characters at str without
+ * copying them.  The data must be null-terminated and must remain
+ * unchanged for as long as the program runs, which is the case for a
+ * string literal (the _str suffix in mcl::literals calls this).
+ * Because there is nothing to free, the String has no StringRef and is
+ * never reference counted.
+ *
+ * @param str The data to refer to.
+ * @param len The number of characters in str.
+ */
+inline String String::literal(const char* str, size_t len) {
+  String result;
+  result.rep.shared.ref = 0;
+  result.rep.shared.ptr = str;
+  result.rep.shared.len = len;
+  return result;
+}
+
+/**
+ * Assign str to this instance by taking over its data.  str is left
+ * empty.
+ *
+ * @param str The string to move.
+ */
+inline void String::assign(String&& str) {
+  if (&str == this)
+    return;
+
+  release();
+  rep = str.rep;
+  str.setLocal((size_t)0);
+}
+
+/**
+ * Switch to the local representation with room for len characters
+ * (len must not exceed LOCAL_CAPACITY).  The string is terminated, and
+ * a pointer to the space for its characters is returned.  Any shared
+ * reference must already have been released.
+ */
+inline char* String::setLocal(size_t len) {
+  rep.local[TAG_POS] = (char)(LOCAL_FLAG | len);
+  rep.local[LOCAL_POS + len] = 0;
+  return rep.local + LOCAL_POS;
+}
+
+/**
+ * Copy len characters of str into the local representation (len must
+ * not exceed LOCAL_CAPACITY).  The source may overlap this string.
+ */
+inline void String::setLocal(const char* str, size_t len) {
+  memmove(rep.local + LOCAL_POS, str, len);
+  setLocal(len);
+}
+
+/**
+ * Switch to the shared representation of the data in ref.  This
+ * instance takes over the reference the caller holds on ref.
+ */
+inline void String::setShared(StringRef* ref) {
+  rep.shared.ref = ref;
+  rep.shared.ptr = ref->data;
+  rep.shared.len = ref->size;
+}
+
+/**
+ * Switch to the shared representation of len characters at ptr in a
+ * StringArena.  Any shared reference must already have been released.
+ */
+inline void String::setArena(const char* ptr, size_t len) {
+  rep.shared.ref = &ARENA_STRING;
+  rep.shared.ptr = ptr;
+  rep.shared.len = len;
+}
+
+/**
+ * Return true if the data of this String is followed by a null
+ * character.  This is always the case except for some slices and some
+ * strings taking over external data.
+ */
+inline bool String::isTerminated() const {
+  return isTerminatedAt(size());
+}
+
+/**
+ * Return true if the character at pos (which may be the position just
+ * past the end of this String) is a null character.  Within the data
+ * of a StringRef this is examined directly; just past its end, the
+ * StringRef records whether there is one (the byte there may not be
+ * readable).
+ */
+inline bool String::isTerminatedAt(size_t pos) const {
+  if (isLocal())
+    return rep.local[LOCAL_POS + pos] == 0;
+
+  const StringRef* ref = rep.shared.ref;
+  const char* p = rep.shared.ptr + pos;
+  if (ref && p == ref->data + ref->size)
+    return ref->terminated;
+
+  return *p == 0;
+}
+
+/**
+ * Call each once for every field of this String separated by the
+ * delimLen characters at delim, passing it a String (an lvalue, which
+ * each may move from) holding the field.  Fields are slices of this
+ * String, so no characters are copied except for fields short enough
+ * to be stored locally.  Returns the number of fields.
+ */
+template <class Function>
+size_t String::splitFields(const char* delim, size_t delimLen,
+                           Function& each) const {
+  const char* d = data();
+  const char* end = d + size();
+  const char* start = d;
+  String field;
+  size_t fields = 0;
+
+  for (;;) {
+    const char* found = 0;
+    if (delimLen == 1)
+      found = (const char*)mem_find_char(start, end - start, *delim);
+    else if (delimLen > 1)
+      found = (const char*)mem_find(start, end - start, delim, delimLen);
+
+    const char* stop = found ? found : end;
+    field.assignSlice(*this, start - d, stop - start, false);
+    each(field);
+    fields++;
+
+    if (!found)
+      return fields;
+    start = found + delimLen;
+  }
+}
+
+/**
+ * Return true if str has the same contents as this string (including
+ * any embedded nulls).  Characters are compared only when nothing
+ * cheaper decides the answer.  Strings of different sizes are never
+ * equal, and strings that share the same data are always equal.  Two
+ * strings interned in the same StringPool are equal only if they share
+ * the same data.  Strings whose hash values are already known are
+ * unequal if the hash values differ.
+ */
+inline bool String::equals(const String& str) const {
+  size_t len = size();
+  if (len != str.size())
+    return false;
+
+  const char* a = data();
+  const char* b = str.data();
+  if (a == b)
+    return true;
+
+  // the rest only applies to counted strings that use all of their data
+  if (isCounted() && str.isCounted()) {
+    const StringRef* aRef = rep.shared.ref;
+    const StringRef* bRef = str.rep.shared.ref;
+
+    if (len == aRef->size && len == bRef->size) {
+      if (aRef->pool && aRef->pool == bRef->pool)
+        return false;
+
+      size_t aHash = aRef->hashCode.load(MEMORY_RELAXED);
+      size_t bHash = bRef->hashCode.load(MEMORY_RELAXED);
+      if (aHash && bHash && aHash != bHash)
+        return false;
+    }
+  }
+
+  return mem_equal(a, b, len);
+}
+
 /**
  * Ensures that pos is within the bounds of this string.  An
  * OutOfBoundsException is thrown otherwise.
  */
 inline void String::checkBounds(size_t pos) const {
-  if (!ref)
-    throw OutOfBoundsException(0, 0, pos);
-  if ((pos < 0) || (pos >= ref->size))
-    throw OutOfBoundsException(0, ref->size - 1, pos);
+  size_t len = size();
+  if (pos >= len)
+    throw OutOfBoundsException(0, len - 1, pos);
 }
 
 /**
- * Acquire a string reference by incrementing its count
+ * Acquire a string reference by incrementing its count (unless it is
+ * immortal).  The owner of a biased reference increments its own count
+ * without an atomic operation.  The increment needs no ordering: the
+ * caller already holds a reference, so the data cannot be freed.
  */
 inline bool String::acquireReference(StringRef* ref) {
-  int* countPtr = &(ref->refCount);
-  int countWas = 0;
+  if (ref->immortal.load(MEMORY_RELAXED))
+    return true;
+
+  StringRefOwner* owner = ref->owner;
+  if (owner) {
+    if (owner == StringRef::currentOwner &&
+        !(ref->refCount.load(MEMORY_RELAXED) & StringRef::BIAS_MERGED)) {
+      ref->biasedCount++;
+      return true;
+    }
 
-  AtomicAdd(countPtr, 1, countWas);
+    ref->refCount.fetchAdd(StringRef::BIAS_UNIT, MEMORY_RELAXED);
+    return true;
+  }
+
+  int countWas = ref->refCount.fetchAdd(1, MEMORY_RELAXED);
 
   return (countWas >= 1);
 }
@@ -204,19 +752,49 @@ inline bool String::acquireReference(StringRef* ref) {
 /**
  * Release a string reference by decrementing its count.  Returns true
  * if the reference has gone out of scope (should be deleted following
- * our release).
+ * our release).  An immortal reference never goes out of scope.  The
+ * decrement has acquire-release ordering, so that every use of the
+ * data by other threads happens before it is freed.
  */
 inline bool String::releaseReference(StringRef* ref) {
-  int* countPtr = &(ref->refCount);
-  int countWas = 0;
+  if (ref->immortal.load(MEMORY_RELAXED))
+    return false;
+
+  StringRefOwner* owner = ref->owner;
+  if (owner) {
+    if (owner == StringRef::currentOwner &&
+        !(ref->refCount.load(MEMORY_RELAXED) & StringRef::BIAS_MERGED)) {
+      bool gone = (--ref->biasedCount == 0 && releaseBiased(ref));
+      if (owner->pending.load(MEMORY_RELAXED))
+        mergeQueued();
+      return gone;
+    }
 
-  AtomicAdd(countPtr, -1, countWas);
+    return releaseShared(ref);
+  }
+
+  int countWas = ref->refCount.fetchAdd(-1, MEMORY_ACQ_REL);
 
   return (countWas <= 1);
 }
 
+namespace literals {
+
+/**
+ * Create a String from a string literal (for example, "Content-Type"_str)
+ * without copying or counting references to its data.  See
+ * String::literal().
+ */
+inline String operator"" _str(const char* str, size_t len) {
+  return String::literal(str, len);
+}
+
+} // namespace literals
+
 } // namespace
 
+// String::format() is defined with the Format class
+#include <mcl/Format.h>
 
 #endif // _MCL_String_h_
 
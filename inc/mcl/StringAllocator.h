@@ -0,0 +1,153 @@
+#ifndef _MCL_StringAllocator_h_
+#define _MCL_StringAllocator_h_
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+/**
+ * StringAllocator
+ *
+ * Memory allocation for the data of Strings.
+ */
+
+#include <stddef.h>
+
+namespace mcl {
+
+/**
+ * StringAllocator is the interface through which the blocks holding
+ * StringRefs (and the data following them) are allocated and freed.
+ * Each StringRef remembers the allocator it came from and is returned
+ * to it, so the allocator used for new blocks may be changed with use()
+ * at any time; however use() is not synchronized with other threads,
+ * so it is best called before they are started.
+ *
+ * The default is SlabAllocator, which is tuned for the many small,
+ * short-lived blocks typical of strings.  MallocAllocator passes every
+ * request on to malloc().  An application may supply its own by
+ * implementing allocate() and deallocate() (and optionally
+ * reallocate()).  Blocks must be aligned for any type, as by malloc().
+ */
+class StringAllocator {
+
+public:
+
+  /** Destructor */
+  virtual ~StringAllocator() { }
+
+  /**
+   * Return a block of size bytes, or 0 if there is not enough memory.
+   * This may be called by any thread.
+   */
+  virtual void* allocate(size_t size) = 0;
+
+  /**
+   * Change the size of a block returned by allocate() from size to
+   * newSize bytes, returning its (possibly new) address, or 0 if there
+   * is not enough memory (in which case the block is unchanged).  The
+   * contents are preserved up to the smaller of the two sizes.
+   */
+  virtual void* reallocate(void* block, size_t size, size_t newSize);
+
+  /**
+   * Free a block of size bytes returned by allocate() or reallocate().
+   * This may be called by a different thread than the one that
+   * allocated it.
+   */
+  virtual void deallocate(void* block, size_t size) = 0;
+
+  /** Return the allocator used for new StringRefs */
+  static StringAllocator* current() { return active; }
+
+  static void use(StringAllocator* allocator);
+
+protected:
+  /** The allocator used for new StringRefs */
+  static StringAllocator* active;
+};
+
+/**
+ * MallocAllocator allocates blocks with malloc().
+ */
+class MallocAllocator : public StringAllocator {
+
+public:
+
+  void* allocate(size_t size);
+  void* reallocate(void* block, size_t size, size_t newSize);
+  void deallocate(void* block, size_t size);
+
+  static MallocAllocator& instance();
+};
+
+/**
+ * SlabAllocator is the default StringAllocator.  Blocks of up to
+ * MAX_BLOCK bytes are rounded up to one of SIZE_CLASSES sizes and
+ * carved out of slabs of SLAB_SIZE bytes, each holding blocks of a
+ * single size.  Larger blocks are allocated with malloc().
+ *
+ * Each thread allocates from its own slabs, and keeps the blocks it
+ * frees on its own lists for reuse, without any locking or atomic
+ * operations.  A block freed by a different thread is pushed onto a
+ * lock-free list belonging to the thread that allocated it, which that
+ * thread takes over in a single exchange the next time its own lists
+ * run out.  When a thread exits, its slabs and lists are handed on to
+ * the next new thread.  Slabs are reused but never returned to the
+ * system.
+ *
+ * The number of blocks allocated and freed in each size class is
+ * counted, for tuning; see stats().
+ */
+class SlabAllocator : public StringAllocator {
+
+public:
+
+  /** Allocation limits */
+  enum {
+    SIZE_CLASSES = 16,
+    MAX_BLOCK = 1024,
+    SLAB_SIZE = 64 * 1024
+  };
+
+  /** Allocation statistics for one size class */
+  struct Stats {
+    /** The size of the blocks in the class (0 for larger blocks) */
+    size_t blockSize;
+    /** The number of blocks allocated */
+    size_t allocations;
+    /** The number of blocks freed */
+    size_t frees;
+    /** The number of bytes allocated */
+    size_t bytesAllocated;
+    /** The number of bytes freed */
+    size_t bytesFreed;
+    /** The number of bytes of slabs reserved for the class */
+    size_t bytesReserved;
+  };
+
+  void* allocate(size_t size);
+  void* reallocate(void* block, size_t size, size_t newSize);
+  void deallocate(void* block, size_t size);
+
+  static SlabAllocator& instance() { return defaultInstance; }
+
+  // statistics
+  static size_t blockSize(int sizeClass);
+  static int sizeClass(size_t size);
+  Stats stats(int sizeClass) const;
+
+protected:
+  friend class StringAllocator;
+
+  /** Constructor (there is a single instance, see instance()) */
+  constexpr SlabAllocator() { }
+
+  static SlabAllocator defaultInstance;
+};
+
+} // namespace
+
+#endif // _MCL_StringAllocator_h_
+
+// Local Variables:
+// mode:C++
+// End:
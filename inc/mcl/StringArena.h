@@ -0,0 +1,121 @@
+#ifndef _MCL_StringArena_h_
+#define _MCL_StringArena_h_
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+/**
+ * StringArena
+ *
+ * A region of memory for Strings that are freed together.
+ */
+
+#include <mcl/config.h>
+
+#include <stddef.h>
+
+namespace mcl {
+
+/**
+ * StringArena is a region that the data of temporary Strings is
+ * allocated from, which is freed all at once when the arena goes out
+ * of scope.  While an arena exists, every String the same thread
+ * creates that is too long to be stored locally takes its data from
+ * the arena (by advancing a pointer) instead of allocating a
+ * StringRef, and copying and destroying such a String involves no
+ * reference counting.
+ *
+ * <code>
+ * void handleRequest(const Request& req) {
+ *   StringArena arena;
+ *
+ *   String path = req.header("path");  // allocated in the arena
+ *   String page = render(path);        // and so is this
+ *
+ *   page.promote();                    // copied out of the arena
+ *   cache.append(page);
+ * }
+ * </code>
+ *
+ * Strings created in an arena must not be used once it is destroyed.
+ * Any String that needs to outlive it, including one stored in a
+ * longer-lived object, must first be given its own heap copy with
+ * String::promote().  The library follows the same rule for the
+ * Strings it keeps: a StringPool, a Rope or a Format copies any data
+ * it is given from an arena, so each may still be used once the arena
+ * is gone (as may the cache behind String::format()).
+ *
+ * Arenas may be nested, in which case Strings are allocated from the
+ * innermost one.  An arena belongs to the thread that created it;
+ * other threads are unaffected by it (although they may read Strings
+ * from it while it exists).
+ */
+class StringArena {
+
+public:
+
+  /** The size of the first block of memory (later ones are larger) */
+  enum { DEFAULT_BLOCK = 4096 };
+
+  StringArena(size_t blockSize = DEFAULT_BLOCK);
+  ~StringArena();
+
+  // allocation
+  inline char* allocate(size_t size);
+
+  // statistics
+  size_t bytesUsed() const { return used + (next - start); }
+  size_t bytesReserved() const { return reserved; }
+
+  /** Return the arena Strings are allocated from by this thread, or 0 */
+  static StringArena* current() { return active; }
+
+protected:
+  // not copyable
+  StringArena(const StringArena&);
+  StringArena& operator=(const StringArena&);
+
+  /** The header of a block of memory, which its data follows */
+  struct Block {
+    Block* next;
+  };
+
+  char* allocateBlock(size_t size);
+
+  /** The innermost arena of the current thread */
+  static _MCL_THREAD_LOCAL StringArena* active;
+
+  /** The arena that was active when this one was created */
+  StringArena* previous;
+  /** The blocks allocated, the newest first */
+  Block* blocks;
+  /** The unused part of the newest block */
+  char* start;
+  char* next;
+  char* end;
+  /** The size of the next block to allocate */
+  size_t blockSize;
+  /** Bytes used in blocks before the newest, and bytes of all blocks */
+  size_t used;
+  size_t reserved;
+};
+
+/**
+ * Return size bytes from the arena, allocating a new block if the
+ * current one is full.  The memory is aligned only to a byte.
+ */
+inline char* StringArena::allocate(size_t size) {
+  if ((size_t)(end - next) < size)
+    return allocateBlock(size);
+
+  char* result = next;
+  next += size;
+  return result;
+}
+
+} // namespace
+
+#endif // _MCL_StringArena_h_
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,129 @@
+#ifndef _MCL_StringBuilder_h_
+#define _MCL_StringBuilder_h_
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+/**
+ * StringBuilder
+ *
+ * Builds a String from a sequence of appended values.
+ */
+
+#include <mcl/String.h>
+
+namespace mcl {
+
+/**
+ * StringBuilder assembles a String piece by piece.  Since a String is
+ * immutable, building one by repeated concatenation would copy the data
+ * at every step; a StringBuilder instead appends to a buffer of its own
+ * and turns it into a String once at the end.
+ *
+ * <code>
+ * StringBuilder b;
+ * b.append("Content-Length: ").append(length).append('\n');
+ * String header = b.toString();
+ * </code>
+ *
+ * The first INLINE_CAPACITY bytes are kept inside the StringBuilder
+ * itself, so short results need no memory allocation until toString()
+ * (and none at all if they are short enough to be stored locally in a
+ * String).  Beyond that the data is kept in a StringRef that doubles in
+ * size as it fills, and toString() hands that StringRef to the new
+ * String instead of copying it.
+ */
+class StringBuilder {
+
+public:
+
+  /** The number of bytes held without allocating memory */
+  enum { INLINE_CAPACITY = 128 };
+
+  StringBuilder();
+  StringBuilder(size_t capacity);
+  ~StringBuilder();
+
+  // accessors
+  const char* data() const { return buf; }
+  size_t size() const { return len; }
+  size_t capacity() const { return cap; }
+
+  // appending
+  StringBuilder& append(const String& str)
+    { return append(str.data(), str.size()); }
+  StringBuilder& append(const char* str);
+  inline StringBuilder& append(const char* str, size_t count);
+  inline StringBuilder& append(char c);
+  StringBuilder& append(char c, size_t repeat);
+  StringBuilder& append(int value)  { return append((long long)value); }
+  StringBuilder& append(long value) { return append((long long)value); }
+  StringBuilder& append(long long value);
+  StringBuilder& append(unsigned int value)
+    { return append((unsigned long long)value); }
+  StringBuilder& append(unsigned long value)
+    { return append((unsigned long long)value); }
+  StringBuilder& append(unsigned long long value);
+  StringBuilder& append(double value);
+
+  // capacity
+  void reserve(size_t capacity);
+  void clear() { len = 0; }
+
+  // conversion
+  String toString();
+
+protected:
+  // not copyable
+  StringBuilder(const StringBuilder&);
+  StringBuilder& operator=(const StringBuilder&);
+
+  void grow(size_t needed);
+  StringBuilder& appendGrowing(const char* str, size_t count);
+
+  /** The data (either local or ref->data) */
+  char* buf;
+  /** The number of bytes appended */
+  size_t len;
+  /** The number of bytes buf has room for */
+  size_t cap;
+  /** The reference holding the data once it outgrows local, or 0 */
+  StringRef* ref;
+  /** The first INLINE_CAPACITY bytes of data */
+  char local[INLINE_CAPACITY];
+};
+
+/**
+ * Append the count bytes at str (which may include null characters).
+ *
+ * @param str   The data to append.
+ * @param count The number of bytes to append.
+ */
+inline StringBuilder& StringBuilder::append(const char* str, size_t count) {
+  if (cap - len < count)
+    return appendGrowing(str, count);
+
+  memcpy(buf + len, str, count);
+  len += count;
+  return *this;
+}
+
+/**
+ * Append the character c.
+ *
+ * @param c The character to append.
+ */
+inline StringBuilder& StringBuilder::append(char c) {
+  if (len == cap)
+    grow(1);
+
+  buf[len++] = c;
+  return *this;
+}
+
+} // namespace
+
+#endif // _MCL_StringBuilder_h_
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,84 @@
+#ifndef _MCL_StringPool_h_
+#define _MCL_StringPool_h_
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+/**
+ * StringPool
+ *
+ * A table of interned (canonical) strings.
+ */
+
+#include <mcl/String.h>
+
+#include <mutex>
+
+namespace mcl {
+
+/**
+ * StringPool interns strings: for any given contents, intern() always
+ * returns a String that refers to the same StringRef.  Holding many
+ * repeated values (header names, labels and so on) as interned strings
+ * means that only one copy of each is kept in memory, and two interned
+ * strings from the same pool can be tested for equality by comparing
+ * pointers rather than characters.
+ *
+ * Every interned string is kept in a StringRef of its own (even short
+ * strings that would otherwise be stored locally).  The pool holds one
+ * reference to each entry.  An entry is unused when that is the only
+ * reference left; evict() removes unused entries, and the pool also
+ * evicts them on its own when it is full, growing only if fewer than
+ * half of its entries were unused.
+ *
+ * A StringPool may be used from multiple threads at once.  Strings
+ * returned by a pool remain valid after the pool is destroyed.
+ */
+class StringPool {
+
+public:
+
+  StringPool(size_t capacity = 64);
+  ~StringPool();
+
+  // interning
+  String intern(const String& str);
+
+  // maintenance
+  size_t evict();
+
+  // statistics
+  size_t size() const;
+  size_t bucketCount() const;
+  size_t bytesSaved() const;
+
+protected:
+  /** A node in a hash bucket */
+  struct Entry {
+    String str;
+    size_t hash;
+    Entry* next;
+  };
+
+  void rehash(size_t newCapacity);
+  size_t evictUnused();
+
+  // not copyable
+  StringPool(const StringPool&);
+  StringPool& operator=(const StringPool&);
+
+  int                id;
+  Entry**            buckets;
+  size_t             capacity;
+  size_t             count;
+  mutable std::mutex lock;
+};
+
+} // namespace
+
+
+#endif // _MCL_StringPool_h_
+
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,72 @@
+#ifndef _MCL_StringTokenizer_h_
+#define _MCL_StringTokenizer_h_
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+/**
+ * StringTokenizer
+ *
+ * Produces the fields of a delimited String one at a time.
+ */
+
+#include <mcl/String.h>
+
+namespace mcl {
+
+/**
+ * StringTokenizer returns the fields of a String separated by a
+ * delimiter, one field per call to next().  Fields are found only as
+ * they are requested, so a caller looking for one field of a long
+ * record does not pay for splitting the rest of it.  The fields are
+ * the same as those produced by String::split(): adjacent delimiters
+ * separate an empty field, and every String has at least one field.
+ *
+ * <code>
+ * StringTokenizer tokens(line, ',');
+ * String field;
+ *
+ * while (tokens.next(field))
+ *   process(field);
+ * </code>
+ *
+ * Each field is a slice of the String being tokenized, sharing its
+ * data (see String::slice()).  The tokenizer keeps its own copy of
+ * the String, so the fields remain valid however the original is used.
+ */
+class StringTokenizer {
+
+public:
+
+  StringTokenizer(const String& str, char delim);
+  StringTokenizer(const String& str, const String& delim);
+
+  // iteration
+  bool hasNext() const { return !done; }
+  bool next(String& field);
+  String next();
+  void reset();
+
+  // accessors
+  const String& string() const { return str; }
+  const String& delimiter() const { return delim; }
+
+protected:
+  /** The string being tokenized */
+  String str;
+  /** The delimiter separating fields */
+  String delim;
+  /** The position where the next field begins */
+  size_t pos;
+  /** The number of fields returned so far */
+  size_t fields;
+  /** Set once the last field has been returned */
+  bool done;
+};
+
+} // namespace
+
+#endif // _MCL_StringTokenizer_h_
+
+// Local Variables:
+// mode:C++
+// End:
@@ -1,46 +1,112 @@
+/**
+ * Move n elements from from to to (which may overlap), leaving from
+ * uninitialized.
+ */
+template <class T>
+inline void VectorStorage<T, false>::relocate(Slot* to, Slot* from, size_t n) {
+  if (RELOCATABLE) {
+    // (through void* to avoid warnings about copying non-trivial types)
+    if (n)
+      memmove(static_cast<void*>(to), static_cast<const void*>(from),
+              n * sizeof(Slot));
+  } else if (to < from) {
+    for (size_t i = 0; i < n; i++) {
+      new (to + i) T(std::move(from[i]));
+      from[i].~T();
+    }
+  } else {
+    for (size_t i = n; i > 0; i--) {
+      new (to + i - 1) T(std::move(from[i - 1]));
+      from[i - 1].~T();
+    }
+  }
+}
+
+/**
+ * Allocate a new element, passing args to its constructor, and store
+ * its address at at.
+ */
+template <class T> template <class... Args>
+inline void VectorStorage<T, true>::construct(Slot* at, Args&&... args) {
+  T* t = new T(std::forward<Args>(args)...);
+  if (!t)
+    throw OutOfMemoryException();
+  *at = t;
+}
+
 /**
  * Default constructor that accepts an optional capacity argument.
  *
  * @param capacity The initial capacity of the vector.
  */
-template <class T> inline Vector<T>::Vector(int capacity) : elems(0), count(0), capacity(0) {
-  elems = new T*[capacity];
-  if (!elems)
-    throw OutOfMemoryException();
+template <class T> inline Vector<T>::Vector(int capacity)
+  : elems(0), count(0), cap(0), growth(GROW_DOUBLE), local(false) {
+  elems = allocate(capacity);
+  cap = capacity;
+}
 
-  this->capacity = capacity;
+/**
+ * Constructor for a subclass that provides the initial array.  The
+ * vector does not free buffer, and moves its items to the heap if it
+ * needs more room.
+ *
+ * @param buffer   An uninitialized array of slots.
+ * @param capacity The number of slots in buffer.
+ */
+template <class T> inline Vector<T>::Vector(Slot* buffer, size_t capacity)
+  : elems(buffer), count(0), cap(capacity), growth(GROW_DOUBLE), local(true) {
 }
 
 /**
- * Copy constructor.  Performs a deep copy of list.
+ * Copy constructor.  Performs a deep copy of list, with only as much
+ * capacity as its items need.
  *
  * @param list The vector to copy
  */
-template <class T> inline Vector<T>::Vector(const Vector<T>& list) : elems(0), count(0), capacity(0) {
+template <class T> inline Vector<T>::Vector(const Vector<T>& list)
+  : elems(0), count(0), cap(0), growth(list.growth), local(false) {
   // allocate memory
-  elems = new T*[list.capacity];
-  if (!elems)
-    throw OutOfMemoryException();
-
-  capacity = list.capacity;
+  elems = allocate(list.count);
+  cap = list.count;
 
   // copy elements
   for (size_t i = 0; i < list.count; i++) {
-    elems[i] = new T( *(list.elems[i]) );
-    if (!elems[i])
-      throw OutOfMemoryException();
-
+    Storage::construct(elems + i, Storage::get(list.elems[i]));
     count++;
   }
 }
 
+/**
+ * Move constructor.  Takes over the contents of list, which is left
+ * empty.  (If list keeps its items in a buffer of its own, they are
+ * moved to a new array instead.)
+ *
+ * @param list The vector to move
+ */
+template <class T> inline Vector<T>::Vector(Vector<T>&& list)
+  : elems(list.elems), count(list.count), cap(list.cap), growth(list.growth),
+    local(false) {
+  if (list.local) {
+    elems = 0;
+    cap = 0;
+    elems = allocate(count);
+    cap = count;
+    Storage::relocate(elems, list.elems, count);
+    list.count = 0;
+    return;
+  }
+
+  list.elems = 0;
+  list.count = 0;
+  list.cap = 0;
+}
+
 /**
  * Destructor
  */
 template <class T> inline Vector<T>::~Vector() {
   clear();
-  if (elems)
-    delete [] elems;
+  release();
 }
 
 /**
@@ -52,7 +118,7 @@ template <class T> inline Vector<T>::~Vector() {
  */
 template <class T> inline T& Vector<T>::item(size_t idx) {
   checkBounds(idx);
-  return *(elems[idx]);
+  return Storage::get(elems[idx]);
 }
 
 /**
@@ -64,7 +130,7 @@ template <class T> inline T& Vector<T>::item(size_t idx) {
  */
 template <class T> inline T Vector<T>::item(size_t idx) const {
   checkBounds(idx);
-  return *(elems[idx]);
+  return Storage::get(elems[idx]);
 }
 
 /**
@@ -73,17 +139,16 @@ template <class T> inline T Vector<T>::item(size_t idx) const {
  * @param item The item to add.
  */
 template <class T> inline void Vector<T>::append(const T& item) {
-  // ensure capacity
-  if (count >= capacity)
-    grow();
-
-  // create the item we'll hold on to
-  T* t = new T(item);
-  if (!t)
-    throw OutOfMemoryException();
+  place(count, item);
+}
 
-  // put it in the list
-  elems[count++] = t;
+/**
+ * Move item to the end of the list.
+ *
+ * @param item The item to add.
+ */
+template <class T> inline void Vector<T>::append(T&& item) {
+  place(count, std::move(item));
 }
 
 /**
@@ -94,22 +159,17 @@ template <class T> inline void Vector<T>::append(const T& item) {
  * @param item The item to add.
  */
 template <class T> inline void Vector<T>::prepend(const T& item) {
-  // ensure capacity
-  if (count >= capacity)
-    grow();
-
-  // create the item we'll hold on to
-  T* t = new T(item);
-  if (!t)
-    throw OutOfMemoryException();
-
-  // make a space for the item
-  if (count)
-    memmove(&elems[1], elems, count * sizeof(T*));
+  place(0, item);
+}
 
-  // put it in the list
-  elems[0] = t;
-  count++;
+/**
+ * Move item to the beginning of the list.  (This performs a memory
+ * move, and so for large lists it may not be an optimal operation.)
+ *
+ * @param item The item to add.
+ */
+template <class T> inline void Vector<T>::prepend(T&& item) {
+  place(0, std::move(item));
 }
 
 /**
@@ -125,24 +185,98 @@ template <class T> inline void Vector<T>::insert(size_t before, const T& item) {
   if ((before < 0) || (before > count))
       throw OutOfBoundsException(0, count, before);
 
-  // ensure capacity
-  if (count >= capacity)
-    grow();
+  place(before, item);
+}
 
-  // create the item we'll hold on to
-  T* t = new T(item);
-  if (!t)
-    throw OutOfMemoryException();
+/**
+ * Move item into the list before the given index (zero-based
+ * indexing).  If the given index is equal to the size of the list, the
+ * item is appended to the end of the list.
+ *
+ * @param before The position before which the item should be added.
+ * @param item   The item to add.
+ */
+template <class T> inline void Vector<T>::insert(size_t before, T&& item) {
+  // check the validity of the index
+  if (before > count)
+      throw OutOfBoundsException(0, count, before);
 
-  // make a space for the item
-  if (before < count)
-    memmove(&elems[before + 1], &elems[before], (count - before) * sizeof(T*));
+  place(before, std::move(item));
+}
 
-  // put it in the list
-  elems[before] = t;
-  count++;
+/**
+ * Construct a new item at the end of the list, passing args to its
+ * constructor.
+ *
+ * @param args The constructor arguments.
+ */
+template <class T> template <class... Args>
+inline void Vector<T>::emplace(Args&&... args) {
+  place(count, std::forward<Args>(args)...);
 }
 
+/**
+ * Construct a new item before the given index (zero-based indexing),
+ * passing args to its constructor.  If the given index is equal to the
+ * size of the list, the item is appended to the end of the list.
+ *
+ * @param before The position before which the item should be added.
+ * @param args   The constructor arguments.
+ */
+template <class T> template <class... Args>
+inline void Vector<T>::emplaceAt(size_t before, Args&&... args) {
+  // check the validity of the index
+  if (before > count)
+      throw OutOfBoundsException(0, count, before);
+
+  place(before, std::forward<Args>(args)...);
+}
+
+/**
+ * Add copies of the n items at items to the end of the list, growing
+ * it at most once.  The items may be part of this list.
+ *
+ * @param items The items to add.
+ * @param n     The number of items.
+ */
+template <class T> inline void Vector<T>::appendRange(const T* items, size_t n) {
+  if (n > (size_t)-1 - count)
+    throw IntegerWrapException();
+
+  if (count + n > cap) {
+    // find items again if they are in the array being replaced
+    const char* from = reinterpret_cast<const char*>(items);
+    const char* start = reinterpret_cast<const char*>(elems);
+    bool own = elems && from >= start && from < start + count * sizeof(Slot);
+
+    reallocate(grownCapacity(count + n));
+    if (own)
+      items = reinterpret_cast<const T*>(
+        reinterpret_cast<const char*>(elems) + (from - start));
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    Storage::construct(elems + count, items[i]);
+    count++;
+  }
+}
+
+/**
+ * Add copies of the items of list to the end of this list, growing it
+ * at most once.  The list may be this one.
+ *
+ * @param list The list whose items to add.
+ */
+template <class T> inline void Vector<T>::appendRange(const Vector<T>& list) {
+  size_t n = list.count;
+  if (count + n > cap)
+    reallocate(grownCapacity(count + n));
+
+  for (size_t i = 0; i < n; i++) {
+    Storage::construct(elems + count, Storage::get(list.elems[i]));
+    count++;
+  }
+}
 
 /**
  * Remove the item at index idx (zero is the index of the first item)
@@ -150,21 +284,20 @@ template <class T> inline void Vector<T>::insert(size_t before, const T& item) {
  *
  * @param idx The index of the item to remove.
  *
- * @return A copy of the removed item.
+ * @return The removed item.
  */
 template <class T> inline T Vector<T>::remove(size_t idx) {
   // validate idx
   checkBounds(idx);
 
-  // save a copy of what we're about to delete
-  T t( *(elems[idx]) );
+  // take what we're about to delete
+  T t( std::move(Storage::get(elems[idx])) );
 
   // delete it
-  delete elems[idx];
+  Storage::destroy(elems + idx);
 
   // close the hole
-  if (idx < (count - 1))
-    memmove(&elems[idx], &elems[idx + 1], (count - idx - 1) * sizeof(T*));
+  Storage::relocate(elems + idx, elems + idx + 1, count - idx - 1);
   count--;
 
   return t;
@@ -175,7 +308,69 @@ template <class T> inline T Vector<T>::remove(size_t idx) {
  */
 template <class T> inline void Vector<T>::clear() {
   while (count)
-    delete elems[--count];
+    Storage::destroy(elems + --count);
+}
+
+/**
+ * Ensure the list has room for at least capacity items, so that adding
+ * items up to that number will not move them.
+ *
+ * @param capacity The number of items to make room for.
+ */
+template <class T> inline void Vector<T>::reserve(size_t capacity) {
+  if (capacity > cap)
+    reallocate(capacity);
+}
+
+/**
+ * Change the number of items in the list to size, removing items from
+ * the end or adding default-constructed ones.
+ *
+ * @param size The new number of items.
+ */
+template <class T> inline void Vector<T>::resize(size_t size) {
+  if (size > cap)
+    reallocate(grownCapacity(size));
+
+  while (count > size)
+    Storage::destroy(elems + --count);
+  while (count < size) {
+    Storage::construct(elems + count);
+    count++;
+  }
+}
+
+/**
+ * Change the number of items in the list to size, removing items from
+ * the end or adding copies of value.
+ *
+ * @param size  The new number of items.
+ * @param value The value of any items added.
+ */
+template <class T> inline void Vector<T>::resize(size_t size, const T& value) {
+  if (size > count) {
+    // copy value first, in case it is about to be moved or removed
+    T copy(value);
+    if (size > cap)
+      reallocate(grownCapacity(size));
+    while (count < size) {
+      Storage::construct(elems + count, copy);
+      count++;
+    }
+  }
+
+  while (count > size)
+    Storage::destroy(elems + --count);
+}
+
+/**
+ * Reduce the capacity of the list to the number of items in it,
+ * returning the rest of its memory.  (A list whose items are still in
+ * a SmallVector's own buffer is left as it is.)
+ */
+template <class T> inline void Vector<T>::shrinkToFit() {
+  if (count < cap && !local)
+    reallocate(count);
 }
 
 /**
@@ -190,27 +385,62 @@ template <class T> inline Vector<T>& Vector<T>::operator=(const Vector<T>& list)
   clear();
 
   // increase the capacity to hold the new list
-  if (capacity < list.count) {
-    capacity = 0;
-    delete [] elems;
-    elems = new T*[list.capacity];
-    if (!elems)
-      throw OutOfMemoryException();
-    capacity = list.capacity;
+  if (cap < list.count) {
+    cap = 0;
+    release();
+    elems = 0;
+    elems = allocate(list.count);
+    cap = list.count;
   }
 
   // copy elements
   for (size_t i = 0; i < list.count; i++) {
-    elems[i] = new T( *(list.elems[i]) );
-    if (!elems[i])
-      throw OutOfMemoryException();
-
+    Storage::construct(elems + i, Storage::get(list.elems[i]));
     count++;
   }
 
   return *this;
 }
 
+/**
+ * Move assignment operator.  Takes over the contents of list, which is
+ * left empty.  (If list keeps its items in a buffer of its own, they
+ * are moved into this list's array instead.)
+ *
+ * @param list  The list to move
+ *
+ * @return A reference to this list
+ */
+template <class T> inline Vector<T>& Vector<T>::operator=(Vector<T>&& list) {
+  if (&list == this)
+    return *this;
+
+  // get rid of the current contents
+  clear();
+  growth = list.growth;
+
+  if (list.local) {
+    reserve(list.count);
+    Storage::relocate(elems, list.elems, list.count);
+    count = list.count;
+    list.count = 0;
+    return *this;
+  }
+
+  release();
+
+  // take over list's
+  elems = list.elems;
+  count = list.count;
+  cap = list.cap;
+
+  list.elems = 0;
+  list.count = 0;
+  list.cap = 0;
+
+  return *this;
+}
+
 /**
  * Equality operator.  Test all values of list to see if list is
  * equal to this list.
@@ -221,7 +451,7 @@ template <class T> inline bool Vector<T>::operator==(const Vector<T>& list) cons
     return false;
 
   for (size_t i = 0; i < count; i++) {
-    if ( *(elems[i]) != *(list.elems[i]) )
+    if (Storage::get(elems[i]) != Storage::get(list.elems[i]))
       return false;
   }
 
@@ -229,33 +459,128 @@ template <class T> inline bool Vector<T>::operator==(const Vector<T>& list) cons
 }
 
 /**
- * Increases the capacity of the vector
+ * Return the capacity to grow the vector to when it is full and at
+ * least needed items must fit: the current capacity multiplied by the
+ * growth factor, or needed if that is more.
  */
-template <class T> inline void Vector<T>::grow() {
-  // pick a new capacity
-  size_t newSize = capacity;
+template <class T> inline size_t Vector<T>::grownCapacity(size_t needed) const {
+  size_t newSize;
+  switch (growth) {
+  case GROW_BY_HALF: newSize = cap + cap / 2; break;
+  case GROW_FOUR_TIMES: newSize = cap * 4; break;
+  default: newSize = cap * 2;
+  }
+
   if (newSize < 16)
     newSize = 16;
-  newSize <<= 2;
-  if (newSize <= capacity)
+  if (newSize <= cap)
     throw IntegerWrapException();
+  if (newSize < needed)
+    newSize = needed;
 
-  // allocate the memory
-  T** newElems = new T*[newSize];
-  if (!newElems)
-      throw OutOfMemoryException();
+  return newSize;
+}
 
-  // copy everything over
-  if (elems) {
-    memcpy(newElems, elems, count * sizeof(T*));
+/**
+ * Move the items to a new array of newSize slots (which must be at
+ * least the number of items).  The array is resized in place with
+ * realloc() if its slots may be moved bitwise and it is on the heap.
+ */
+template <class T> inline void Vector<T>::reallocate(size_t newSize) {
+  if (Storage::RELOCATABLE && newSize && !local) {
+    if (newSize > (size_t)-1 / sizeof(Slot))
+      throw IntegerWrapException();
+
+    Slot* newElems = static_cast<Slot*>(realloc(static_cast<void*>(elems),
+                                                newSize * sizeof(Slot)));
+    if (!newElems)
+      throw OutOfMemoryException();
 
-    // get rid of the old array
-    delete [] elems;
+    elems = newElems;
+    cap = newSize;
+    return;
   }
 
-  // put it all in place
+  Slot* newElems = allocate(newSize);
+  Storage::relocate(newElems, elems, count);
+  release();
+
   elems = newElems;
-  capacity = newSize;
+  cap = newSize;
+}
+
+/**
+ * Construct a new item in the list before the given index (which must
+ * already have been checked), passing args to its constructor.  The
+ * arguments may refer to an item already in the list.
+ */
+template <class T> template <class... Args>
+inline void Vector<T>::place(size_t before, Args&&... args) {
+  if (count < cap && before == count) {
+    Storage::construct(elems + count, std::forward<Args>(args)...);
+  } else if (count < cap || Storage::RELOCATABLE) {
+    // construct the item before moving any that the arguments refer to
+    typename std::aligned_storage<sizeof(Slot), alignof(Slot)>::type space;
+    Slot* t = reinterpret_cast<Slot*>(&space);
+    Storage::construct(t, std::forward<Args>(args)...);
+
+    if (count == cap) {
+      try {
+        reallocate(grownCapacity(count + 1));
+      } catch (...) {
+        Storage::destroy(t);
+        throw;
+      }
+    }
+
+    Storage::relocate(elems + before + 1, elems + before, count - before);
+    Storage::relocate(elems + before, t, 1);
+  } else {
+    // construct the item in a new array, then move the others around it
+    size_t newSize = grownCapacity(count + 1);
+    Slot* newElems = allocate(newSize);
+    try {
+      Storage::construct(newElems + before, std::forward<Args>(args)...);
+    } catch (...) {
+      free(newElems);
+      throw;
+    }
+
+    Storage::relocate(newElems, elems, before);
+    Storage::relocate(newElems + before + 1, elems + before, count - before);
+    release();
+
+    elems = newElems;
+    cap = newSize;
+  }
+
+  count++;
+}
+
+/**
+ * Allocate an (uninitialized) array of n slots.
+ */
+template <class T>
+inline typename Vector<T>::Slot* Vector<T>::allocate(size_t n) {
+  if (n > (size_t)-1 / sizeof(Slot))
+    throw IntegerWrapException();
+  if (!n)
+    return 0;
+
+  Slot* slots = static_cast<Slot*>(malloc(n * sizeof(Slot)));
+  if (!slots)
+    throw OutOfMemoryException();
+  return slots;
+}
+
+/**
+ * Free the array, unless it belongs to a subclass.  The list's array
+ * is on the heap from then on.
+ */
+template <class T> inline void Vector<T>::release() {
+  if (!local)
+    free(elems);
+  local = false;
 }
 
 /**
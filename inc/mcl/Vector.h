@@ -3,14 +3,85 @@
 // Copyright (c) 2007-2011, Jeffrey Hunter
 // See the LICENSE file distributed with this work for restrictions.
 
-#include <mcl/OutofMemoryException.h>
-#include <mcl/OutofBoundsException.h>
+#include <mcl/OutOfMemoryException.h>
+#include <mcl/OutOfBoundsException.h>
 #include <mcl/IntegerWrapException.h>
+#include <mcl/type_traits.h>
 
+#include <stdlib.h>
 #include <string.h>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace mcl {
 
+/**
+ * vector_stores_pointers<T>::value is true if a Vector of T allocates
+ * each element separately and keeps an array of pointers to them, so
+ * that the address of an element never changes while it is in the list.
+ * Otherwise the elements are stored in the array itself, which needs no
+ * allocation per element and keeps them together in memory, but moves
+ * them when the list grows or items are inserted or removed.
+ *
+ * Elements are stored in the array if they are trivially copyable or
+ * no larger than four pointers, which includes String and every
+ * built-in type.  Specialize this template for a type whose elements
+ * must keep their addresses (or are too costly to move):
+ *
+ * <code>
+ * namespace mcl {
+ * template <> struct vector_stores_pointers<Session> {
+ *   static const bool value = true;
+ * };
+ * }
+ * </code>
+ */
+template <class T> struct vector_stores_pointers {
+    static const bool value = !(std::is_trivially_copyable<T>::value ||
+                                sizeof(T) <= 4 * sizeof(void*));
+};
+
+/**
+ * VectorStorage
+ *
+ * The operations on the array of a Vector that depend on how elements
+ * are stored (see vector_stores_pointers).  An array is made of
+ * Slots: the elements themselves, or pointers to them.  RELOCATABLE is
+ * set if slots may be moved with memmove() or realloc() (see
+ * is_trivially_relocatable).
+ */
+template <class T, bool Pointers = vector_stores_pointers<T>::value>
+struct VectorStorage;
+
+template <class T> struct VectorStorage<T, false> {
+    typedef T Slot;
+    static const bool RELOCATABLE = is_trivially_relocatable<T>::value;
+
+    static T& get(Slot& slot) { return slot; }
+    static const T& get(const Slot& slot) { return slot; }
+
+    template <class... Args> static void construct(Slot* at, Args&&... args)
+        { new (at) T(std::forward<Args>(args)...); }
+    static void destroy(Slot* at) { at->~T(); }
+
+    static inline void relocate(Slot* to, Slot* from, size_t n);
+};
+
+template <class T> struct VectorStorage<T, true> {
+    typedef T* Slot;
+    static const bool RELOCATABLE = true;
+
+    static T& get(Slot& slot) { return *slot; }
+    static const T& get(const Slot& slot) { return *slot; }
+
+    template <class... Args> static void construct(Slot* at, Args&&... args);
+    static void destroy(Slot* at) { delete *at; }
+
+    static void relocate(Slot* to, Slot* from, size_t n)
+        { if (n) memmove(to, from, n * sizeof(Slot)); }
+};
+
 /**
  * Vector
  *
@@ -18,13 +89,30 @@ namespace mcl {
  * array-backed list.  Insertions and deletions are only optimal at
  * the end of the list, but it is fast to access list elements by
  * their index.
+ *
+ * Most types are stored in the array itself, in which case references
+ * to elements are only valid until the list is next changed; see
+ * vector_stores_pointers.
+ *
+ * When the array is full its capacity is doubled, or multiplied by
+ * another factor chosen with setGrowthPolicy() (1.5 saves memory for
+ * large lists, 4 saves copying for lists that grow quickly).  If the
+ * number of items is known in advance, reserve() or appendRange() make
+ * room for them all at once.
+ *
+ * A SmallVector is a Vector that keeps its first few items in the
+ * object itself.
  */
 template <class T> class Vector {
 
 public:
 
+    /** How much the capacity is multiplied by when the list is full */
+    enum Growth { GROW_BY_HALF, GROW_DOUBLE, GROW_FOUR_TIMES };
+
     inline Vector(int capacity = 16);
     inline Vector(const Vector<T>& list);
+    inline Vector(Vector<T>&& list);
     inline ~Vector();
 
     // accessors
@@ -33,13 +121,27 @@ public:
     T& operator[](size_t idx)       { return item(idx); }
     T  operator[](size_t idx) const { return item(idx); }
     size_t size() const { return count; }
+    size_t capacity() const { return cap; }
 
     // insertion
     inline void append(const T& item);
+    inline void append(T&& item);
     inline void prepend(const T& item);
+    inline void prepend(T&& item);
     inline void insert(size_t before, const T& item);
+    inline void insert(size_t before, T&& item);
     inline void push(const T& item)    { append(item); }
+    inline void push(T&& item)         { append(std::move(item)); }
     inline void unshift(const T& item) { prepend(item); }
+    inline void unshift(T&& item)      { prepend(std::move(item)); }
+
+    // construction in place
+    template <class... Args> inline void emplace(Args&&... args);
+    template <class... Args> inline void emplaceAt(size_t before, Args&&... args);
+
+    // bulk insertion
+    inline void appendRange(const T* items, size_t n);
+    inline void appendRange(const Vector<T>& list);
 
     // deletion
     inline T remove(size_t idx);
@@ -48,19 +150,47 @@ public:
     inline T shift() { return remove(0); }
     inline void clear();
 
+    // capacity
+    inline void reserve(size_t capacity);
+    inline void resize(size_t size);
+    inline void resize(size_t size, const T& value);
+    inline void shrinkToFit();
+    Growth growthPolicy() const { return growth; }
+    void setGrowthPolicy(Growth policy) { growth = policy; }
+
     // other operators
     inline Vector<T>& operator=(const Vector<T>& list);
+    inline Vector<T>& operator=(Vector<T>&& list);
     inline bool operator==(const Vector<T>& list) const;
     inline bool operator!=(const Vector<T>& list) const
         { return (! (*this == list)); }
 
 protected:
+    typedef VectorStorage<T> Storage;
+    typedef typename Storage::Slot Slot;
+
     inline void checkBounds(size_t pos) const;
-    inline void grow();
+    inline size_t grownCapacity(size_t needed) const;
+    inline void reallocate(size_t newSize);
+    template <class... Args> inline void place(size_t before, Args&&... args);
+    static inline Slot* allocate(size_t n);
+    inline void release();
+
+    inline Vector(Slot* buffer, size_t capacity);
 
-    T**    elems;
+    Slot*  elems;
     size_t count;
-    size_t capacity;
+    size_t cap;
+    Growth growth;
+    /** Set if elems is a buffer of a subclass instead of the heap */
+    bool   local;
+};
+
+/**
+ * A Vector holds no pointers to itself, so it may be moved bitwise.
+ */
+template <class T> struct is_trivially_relocatable<Vector<T> > {
+    static const bool value = true;
 };
 
 #include "Vector.cpp"
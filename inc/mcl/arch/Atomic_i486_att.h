@@ -33,13 +33,108 @@
  *  prevVal - output variable (int) will contain the value of ptr prior to addition
  */
 #define AtomicAdd(incPtr, val, prevVal) \
+  do { \
+    int _mclVal = (val); \
+    __asm__ __volatile__ ( \
+      "lock\n\t" \
+      "xaddl %0, (%1)" \
+      : "+r" (_mclVal) \
+      : "r" (incPtr) \
+      : "memory", "cc" ); \
+    prevVal = _mclVal; \
+  } while (0)
+
+/*
+ * The compare and exchange instruction (AT&T/GAS syntax):
+ *
+ *  CMPXCHG src, dst
+ *
+ * compares the accumulator (EAX) with dst.  If they are equal, src is
+ * stored in dst, otherwise dst is loaded into the accumulator.  Either
+ * way the accumulator ends up holding the value of dst prior to the
+ * operation.  With the lock prefix the comparison and store are
+ * performed as one atomic operation.
+ *
+ * (this instruction requires a 486 or better processor)
+ */
+
+/*
+ * Atomic compare and exchange macro
+ *
+ *  ptr     - dword pointer (int*) to the address to update
+ *  oldVal  - value (int) ptr is expected to contain
+ *  newVal  - value (int) to store if ptr contains oldVal
+ *  prevVal - output variable (int) will contain the value of ptr prior to
+ *            the operation (the exchange took place if it equals oldVal)
+ */
+#define AtomicCompareExchange(ptr, oldVal, newVal, prevVal) \
   __asm__ __volatile__ ( \
     "lock\n\t" \
-    "xaddl %2, (%1)\n\t" \
-    "movl %2, %0" \
-    : "=m" (prevVal) \
-    : "r" (incPtr), "r" (val) \
-    : "memory" )
+    "cmpxchgl %3, (%1)" \
+    : "=a" (prevVal) \
+    : "r" (ptr), "a" (oldVal), "r" (newVal) \
+    : "memory", "cc" )
+
+/*
+ * Atomic exchange macro (XCHG with a memory operand is always locked)
+ *
+ *  ptr     - dword pointer (int*) to the address to update
+ *  newVal  - value (int) to store
+ *  prevVal - output variable (int) will contain the value of ptr prior to
+ *            the operation
+ */
+#define AtomicExchange(ptr, newVal, prevVal) \
+  do { \
+    int _mclVal = (newVal); \
+    __asm__ __volatile__ ( \
+      "xchgl %0, (%1)" \
+      : "+r" (_mclVal) \
+      : "r" (ptr) \
+      : "memory" ); \
+    prevVal = _mclVal; \
+  } while (0)
+
+/*
+ * Pointer-sized versions of the compare and exchange and exchange
+ * macros.  The operand size is taken from the registers holding the
+ * values, which must be of type intptr_t.
+ */
+#define AtomicCompareExchangePtr(ptr, oldVal, newVal, prevVal) \
+  __asm__ __volatile__ ( \
+    "lock\n\t" \
+    "cmpxchg %3, (%1)" \
+    : "=a" (prevVal) \
+    : "r" (ptr), "a" (oldVal), "r" (newVal) \
+    : "memory", "cc" )
+
+#define AtomicExchangePtr(ptr, newVal, prevVal) \
+  do { \
+    intptr_t _mclVal = (newVal); \
+    __asm__ __volatile__ ( \
+      "xchg %0, (%1)" \
+      : "+r" (_mclVal) \
+      : "r" (ptr) \
+      : "memory" ); \
+    prevVal = _mclVal; \
+  } while (0)
+
+/*
+ * Full memory barrier (a locked no-op on the top of the stack, which
+ * unlike MFENCE is available on every processor)
+ */
+#ifdef __x86_64__
+#define AtomicFence() \
+  __asm__ __volatile__ ("lock\n\taddl $0, (%%rsp)" : : : "memory", "cc")
+#else
+#define AtomicFence() \
+  __asm__ __volatile__ ("lock\n\taddl $0, (%%esp)" : : : "memory", "cc")
+#endif
+
+/*
+ * Compiler barrier (prevents the compiler from moving memory accesses
+ * across it, without emitting any instruction)
+ */
+#define AtomicCompilerBarrier() __asm__ __volatile__ ("" : : : "memory")
 
 
 #endif // _MCL_Atomic_i486_att_h_
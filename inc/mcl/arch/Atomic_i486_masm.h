@@ -9,6 +9,8 @@
  * Implementation for Intel 486 or better processors using MASM syntax
  */
 
+#include <intrin.h>
+
 /*
  * The exchange and add instruction (Intel/MASM syntax):
  *
@@ -40,6 +42,76 @@
     __asm mov prevVal, eax \
   }
 
+/*
+ * The compare and exchange instruction (Intel/MASM syntax):
+ *
+ *  CMPXCHG dst, src
+ *
+ * compares the accumulator (EAX) with dst.  If they are equal, src is
+ * stored in dst, otherwise dst is loaded into the accumulator.  Either
+ * way the accumulator ends up holding the value of dst prior to the
+ * operation.  With the lock prefix the comparison and store are
+ * performed as one atomic operation.
+ *
+ * (this instruction requires a 486 or better processor)
+ */
+
+/*
+ * Atomic compare and exchange macro
+ *
+ *  ptr     - dword pointer (int*) to the address to update
+ *  oldVal  - value (int) ptr is expected to contain
+ *  newVal  - value (int) to store if ptr contains oldVal
+ *  prevVal - output variable (int) will contain the value of ptr prior to
+ *            the operation (the exchange took place if it equals oldVal)
+ */
+#define AtomicCompareExchange(ptr, oldVal, newVal, prevVal) \
+  __asm { \
+    __asm mov eax, oldVal \
+    __asm mov ebx, ptr \
+    __asm mov ecx, newVal \
+    __asm lock cmpxchg dword ptr [ebx], ecx \
+    __asm mov prevVal, eax \
+  }
+
+/*
+ * Atomic exchange macro (XCHG with a memory operand is always locked)
+ *
+ *  ptr     - dword pointer (int*) to the address to update
+ *  newVal  - value (int) to store
+ *  prevVal - output variable (int) will contain the value of ptr prior to
+ *            the operation
+ */
+#define AtomicExchange(ptr, newVal, prevVal) \
+  __asm { \
+    __asm mov eax, newVal \
+    __asm mov ebx, ptr \
+    __asm xchg dword ptr [ebx], eax \
+    __asm mov prevVal, eax \
+  }
+
+/*
+ * Pointer-sized versions of the compare and exchange and exchange
+ * macros (pointers are the same size as an int on x86)
+ */
+#define AtomicCompareExchangePtr AtomicCompareExchange
+#define AtomicExchangePtr        AtomicExchange
+
+/*
+ * Full memory barrier (a locked no-op on the top of the stack, which
+ * unlike MFENCE is available on every processor)
+ */
+#define AtomicFence() \
+  __asm { \
+    __asm lock add dword ptr [esp], 0 \
+  }
+
+/*
+ * Compiler barrier (prevents the compiler from moving memory accesses
+ * across it, without emitting any instruction)
+ */
+#define AtomicCompilerBarrier() _ReadWriteBarrier()
+
 
 #endif // _MCL_Atomic_i486_masm_h_
 
@@ -10,7 +10,33 @@
 /**
  * Values used in configuration
  */
+#define _MCL_ARCH_UNKNOWN   0
 #define _MCL_ARCH_X86       1
+#define _MCL_ARCH_X86_64    2
+#define _MCL_ARCH_AARCH64   3
+
+/**
+ * Processor architecture
+ */
+#if defined(__x86_64__) || defined(_M_X64)
+#define _MCL_ARCH _MCL_ARCH_X86_64
+#elif defined(__i386__) || defined(_M_IX86)
+#define _MCL_ARCH _MCL_ARCH_X86
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define _MCL_ARCH _MCL_ARCH_AARCH64
+#else
+#define _MCL_ARCH _MCL_ARCH_UNKNOWN
+#endif
+
+/**
+ * Atomic operations: std::atomic (_MCL_ATOMIC_STD) unless the inline
+ * assembly for x86 processors (_MCL_ATOMIC_ASM) is defined instead.
+ * The library and the programs using it must be compiled with the same
+ * choice.
+ */
+#ifndef _MCL_ATOMIC_ASM
+#define _MCL_ATOMIC_STD
+#endif
 
 /**
  * Windows configuration
@@ -19,6 +45,33 @@
 #define _MCL_MASM_SYNTAX
 #endif
 
+/**
+ * Thread-local storage for plain data
+ */
+#ifdef WIN32
+#define _MCL_THREAD_LOCAL __declspec(thread)
+#else
+#define _MCL_THREAD_LOCAL __thread
+#endif
+
+/**
+ * Byte order (little-endian unless the compiler reports otherwise)
+ */
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__)
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define _MCL_BIG_ENDIAN
+#endif
+#endif
+
+/**
+ * Vector instruction support (x86 SIMD code paths are compiled when the
+ * compiler supports selecting them per function, and are chosen at run
+ * time based on the processor)
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define _MCL_X86_SIMD
+#endif
+
 /**
  * Optional constants not used under Windows
  */
@@ -28,7 +81,6 @@
 /**
  * General configurable parameters
  */
-#define _MCL_ARCH       _MCL_ARCH_X86
 #define _MCL_LINE_LIMIT 4096
 #define _MCL_EOL        '\n'
 
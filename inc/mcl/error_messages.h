@@ -11,6 +11,9 @@ extern const char* ERROR_MESSAGES[];
 #define _MCL_ERR_INVALID_REF_COUNT_           mcl::ERROR_MESSAGES[1]
 #define _MCL_ERR_OUT_OF_MEMORY_               mcl::ERROR_MESSAGES[2]
 #define _MCL_ERR_OUT_OF_BOUNDS_               mcl::ERROR_MESSAGES[3]
+#define _MCL_ERR_IO_                          mcl::ERROR_MESSAGES[4]
+#define _MCL_ERR_NUMBER_FORMAT_               mcl::ERROR_MESSAGES[5]
+#define _MCL_ERR_FORMAT_                      mcl::ERROR_MESSAGES[6]
 
 #endif // _MCL_error_messages_h_
 
@@ -0,0 +1,36 @@
+#ifndef _MCL_memory_functions_h_
+#define _MCL_memory_functions_h_
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+/**
+ * Functions operating on blocks of memory of a known size
+ *
+ * Where the processor supports it, these use vector (SIMD)
+ * instructions, with the best available implementation selected at
+ * run time.
+ */
+
+#include <stddef.h>
+
+namespace mcl {
+
+int mem_compare(const void* a, const void* b, size_t len);
+bool mem_equal(const void* a, const void* b, size_t len);
+
+const void* mem_find_char(const void* data, size_t len, char c);
+const void* mem_rfind_char(const void* data, size_t len, char c);
+size_t mem_count_char(const void* data, size_t len, char c);
+
+const void* mem_find(const void* haystack, size_t hlen,
+                     const void* needle, size_t nlen);
+const void* mem_rfind(const void* haystack, size_t hlen,
+                      const void* needle, size_t nlen);
+
+} // namespace
+
+#endif // _MCL_memory_functions_h_
+
+// Local Variables:
+// mode:C++
+// End:
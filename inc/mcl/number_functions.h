@@ -0,0 +1,38 @@
+#ifndef _MCL_number_functions_h_
+#define _MCL_number_functions_h_
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+/**
+ * Functions converting numbers to and from their decimal representation
+ *
+ * The formatting functions write the characters (without a null
+ * terminator) to a buffer of at least NUMBER_BUFFER_SIZE bytes and
+ * return how many were written.  The parsing functions accept exactly
+ * the len characters at str, throwing a NumberFormatException if they
+ * are not a number of the required form (including if they are empty or
+ * contain white space).
+ */
+
+#include <stddef.h>
+
+namespace mcl {
+
+/** The room needed by the formatting functions */
+#define NUMBER_BUFFER_SIZE 32
+
+size_t format_uint(char* buf, unsigned long long value);
+size_t format_int(char* buf, long long value);
+size_t format_double(char* buf, double value);
+
+unsigned long long parse_uint(const char* str, size_t len);
+long long parse_int(const char* str, size_t len);
+double parse_double(const char* str, size_t len);
+
+} // namespace
+
+#endif // _MCL_number_functions_h_
+
+// Local Variables:
+// mode:C++
+// End:
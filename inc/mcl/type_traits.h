@@ -0,0 +1,61 @@
+#ifndef _MCL_type_traits_h_
+#define _MCL_type_traits_h_
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+/**
+ * Type traits used by the containers
+ */
+
+#include <type_traits>
+
+namespace mcl {
+
+/**
+ * is_trivially_relocatable<T>::value is true if an object of type T may
+ * be moved to another address by copying its bytes (with memcpy,
+ * memmove or realloc) and then forgetting the original, instead of
+ * move-constructing a new object and destroying the old one.  That is
+ * the case for every trivially copyable type (including the integer
+ * and floating-point types and pointers), and also for most classes
+ * that hold no pointers to themselves: a String, for instance, can be
+ * moved bitwise without touching its reference count.
+ *
+ * Containers use this to move elements in bulk when they grow or when
+ * items are inserted or removed.  A class opts in with
+ * _MCL_TRIVIALLY_RELOCATABLE, used outside of any namespace:
+ *
+ * <code>
+ * class Handle {
+ *   Resource* resource;   // not a pointer into the Handle itself
+ *   ...
+ * };
+ *
+ * _MCL_TRIVIALLY_RELOCATABLE(Handle)
+ * </code>
+ *
+ * A class that may point to itself, or that registers its address
+ * anywhere, must not opt in.
+ */
+template <class T> struct is_trivially_relocatable {
+  static const bool value = std::is_trivially_copyable<T>::value;
+};
+
+} // namespace
+
+/**
+ * Declare that the class type may be moved by copying its bytes (see
+ * is_trivially_relocatable).
+ */
+#define _MCL_TRIVIALLY_RELOCATABLE(type)                        \
+  namespace mcl {                                               \
+  template <> struct is_trivially_relocatable<type> {           \
+    static const bool value = true;                             \
+  };                                                            \
+  }
+
+#endif // _MCL_type_traits_h_
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,493 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+/**
+ * Format implementation
+ */
+
+#include <mcl/Format.h>
+#include <mcl/StringBuilder.h>
+#include <mcl/FormatException.h>
+#include <mcl/OutOfMemoryException.h>
+#include <mcl/number_functions.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace mcl {
+
+namespace {
+
+/** The largest width or precision accepted */
+const int MAX_WIDTH = 100000;
+
+/**
+ * The Formats parsed for String::format() by the current thread, each
+ * stored at a position given by the address of its format string
+ */
+struct FormatCache {
+  enum { SIZE = 64 };
+
+  struct Entry {
+    const char* key;
+    Format* format;
+  };
+
+  Entry entries[SIZE];
+
+  FormatCache() { memset(entries, 0, sizeof(entries)); }
+  ~FormatCache();
+};
+
+FormatCache::~FormatCache() {
+  for (int i = 0; i < SIZE; i++)
+    delete entries[i].format;
+}
+
+thread_local FormatCache formatCache;
+
+/**
+ * Parse a width or precision at p, returning the position after it.
+ */
+const char* parseNumber(const char* p, const char* end, int& value) {
+  value = 0;
+  while (p < end && *p >= '0' && *p <= '9') {
+    value = value * 10 + (*p++ - '0');
+    if (value > MAX_WIDTH)
+      throw FormatException();
+  }
+  return p;
+}
+
+} // namespace
+
+
+/**
+ * Create a FormatArg for the C string str, which may be 0.
+ *
+ * @param str The null-terminated string.
+ */
+FormatArg::FormatArg(const char* str) : type(STRING), size(0) {
+  if (!str)
+    str = "(null)";
+  value.s.data = str;
+  value.s.len = strlen(str);
+}
+
+/**
+ * Parse the null-terminated format string format.  A FormatException
+ * is thrown if it is not valid.  The text is kept outside of any
+ * StringArena, since a Format may outlive it.
+ *
+ * @param format The format string.
+ */
+Format::Format(const char* format)
+  : text(format), literals(0), specs(0), count(0)
+{
+  text.promote();
+  parse();
+}
+
+/**
+ * Parse the format string format.  A FormatException is thrown if it
+ * is not valid.  The text is kept outside of any StringArena.
+ *
+ * @param format The format string.
+ */
+Format::Format(const String& format)
+  : text(format), literals(0), specs(0), count(0)
+{
+  text.promote();
+  parse();
+}
+
+/**
+ * Destructor
+ */
+Format::~Format() {
+  delete[] literals;
+  delete[] specs;
+}
+
+/**
+ * Parse text into its literal text and conversions.
+ */
+void Format::parse() {
+  const char* p = text.data();
+  const char* end = p + text.size();
+
+  // every conversion begins with a '%'
+  size_t n = 1;
+  for (const char* q = p; q < end; q++)
+    if (*q == '%')
+      n++;
+
+  literals = new char[text.size() + 1];
+  if (!literals)
+    throw OutOfMemoryException();
+
+  try {
+    specs = new Spec[n];
+    if (!specs)
+      throw OutOfMemoryException();
+
+    size_t lit = 0;
+    Spec* s = specs;
+
+    while (p < end) {
+      if (*p != '%') {
+        literals[lit++] = *p++;
+        continue;
+      }
+
+      if (++p < end && *p == '%') {
+        literals[lit++] = *p++;
+        continue;
+      }
+
+      s->literalEnd = lit;
+      s->flags = 0;
+      s->width = -1;
+      s->precision = -1;
+      s->length = 0;
+
+      for (bool flag = true; flag && p < end; ) {
+        switch (*p) {
+        case '-': s->flags |= LEFT;      p++; break;
+        case '+': s->flags |= PLUS;      p++; break;
+        case ' ': s->flags |= SPACE;     p++; break;
+        case '0': s->flags |= ZERO;      p++; break;
+        case '#': s->flags |= ALTERNATE; p++; break;
+        default:  flag = false;
+        }
+      }
+
+      if (p < end && *p >= '1' && *p <= '9')
+        p = parseNumber(p, end, s->width);
+      if (p < end && *p == '.')
+        p = parseNumber(p + 1, end, s->precision);
+
+      // other length modifiers are not needed
+      if (p < end && *p == 'h') {
+        s->length = sizeof(short);
+        if (++p < end && *p == 'h') {
+          s->length = sizeof(char);
+          p++;
+        }
+      }
+      while (p < end && (*p == 'l' || *p == 'L' || *p == 'q' ||
+                         *p == 'j' || *p == 'z' || *p == 't'))
+        p++;
+
+      if (p == end)
+        throw FormatException();
+
+      switch (*p) {
+      case 'd': case 'i': case 'u': case 'x': case 'X': case 'o':
+      case 'c': case 's':
+      case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+      case 'a': case 'A':
+        break;
+      default:
+        throw FormatException();
+      }
+
+      s->type = *p++;
+      s++;
+      count++;
+    }
+
+    s->literalEnd = lit;
+    s->type = 0;
+  } catch (...) {
+    delete[] literals;
+    delete[] specs;
+    throw;
+  }
+}
+
+/**
+ * Return a String formatted from the n values in args.  A
+ * FormatException is thrown if there are too few or too many of them,
+ * or one does not suit its conversion.
+ *
+ * The result is built in a StringBuilder, so it is written in a single
+ * pass, without being measured first, and the finished String takes
+ * over the builder's memory rather than copying it.  At most one
+ * StringRef is allocated for a result of less than
+ * StringBuilder::INLINE_CAPACITY bytes, and none at all for one short
+ * enough to be stored locally.
+ *
+ * @param args The values to format.
+ * @param n    The number of values.
+ */
+String Format::apply(const FormatArg* args, size_t n) const {
+  StringBuilder b;
+  append(b, args, n);
+  return b.toString();
+}
+
+/**
+ * Append the result of formatting the n values in args to b.  A
+ * FormatException is thrown if there are too few or too many of them,
+ * or one does not suit its conversion.
+ *
+ * @param b    The builder to append to.
+ * @param args The values to format.
+ * @param n    The number of values.
+ */
+void Format::append(StringBuilder& b, const FormatArg* args, size_t n) const {
+  if (n != count)
+    throw FormatException();
+
+  size_t start = 0;
+  for (const Spec* s = specs; ; s++) {
+    b.append(literals + start, s->literalEnd - start);
+    start = s->literalEnd;
+    if (!s->type)
+      return;
+
+    convert(b, *s, *args++);
+  }
+}
+
+/**
+ * Return the parsed form of the null-terminated format string format,
+ * which is kept in a cache belonging to the current thread.  Entries
+ * are found by the address of the format string, and the text is
+ * compared as well, so a buffer reused for another format is parsed
+ * again rather than confused with the first.  The Format returned
+ * remains valid until the thread next calls cached().
+ *
+ * @param format The format string.
+ */
+const Format& Format::cached(const char* format) {
+  uintptr_t address = (uintptr_t)format;
+  FormatCache::Entry& e =
+    formatCache.entries[((address >> 4) ^ (address >> 10)) &
+                        (FormatCache::SIZE - 1)];
+
+  if (e.key == format) {
+    size_t len = e.format->text.size();
+    if (strncmp(format, e.format->text.data(), len) == 0 && !format[len])
+      return *e.format;
+  }
+
+  Format* parsed = new Format(format);
+  if (!parsed)
+    throw OutOfMemoryException();
+
+  delete e.format;
+  e.key = format;
+  e.format = parsed;
+  return *parsed;
+}
+
+/**
+ * Append arg to b as spec describes.
+ */
+void Format::convert(StringBuilder& b, const Spec& spec, const FormatArg& arg) {
+  char buf[NUMBER_BUFFER_SIZE];
+
+  switch (spec.type) {
+  case 'd': case 'i': case 'u': case 'x': case 'X': case 'o':
+    appendInteger(b, spec, arg);
+    return;
+
+  case 'c':
+    if (arg.type == FormatArg::CHAR)
+      buf[0] = arg.value.c;
+    else if (arg.type == FormatArg::INT || arg.type == FormatArg::UINT)
+      buf[0] = (char)arg.value.u;
+    else
+      throw FormatException();
+    appendPadded(b, spec, buf, 1);
+    return;
+
+  case 's':
+    switch (arg.type) {
+    case FormatArg::STRING: {
+      size_t len = arg.value.s.len;
+      if (spec.precision >= 0 && (size_t)spec.precision < len)
+        len = spec.precision;
+      appendPadded(b, spec, arg.value.s.data, len);
+      return;
+    }
+    case FormatArg::INT:
+      appendPadded(b, spec, buf, format_int(buf, arg.value.i));
+      return;
+    case FormatArg::UINT:
+      appendPadded(b, spec, buf, format_uint(buf, arg.value.u));
+      return;
+    case FormatArg::DOUBLE:
+      appendPadded(b, spec, buf, format_double(buf, arg.value.d));
+      return;
+    case FormatArg::CHAR:
+      appendPadded(b, spec, &arg.value.c, 1);
+      return;
+    default:
+      throw FormatException();
+    }
+
+  default:
+    if (arg.type == FormatArg::DOUBLE)
+      appendDouble(b, spec, arg.value.d);
+    else if (arg.type == FormatArg::INT)
+      appendDouble(b, spec, (double)arg.value.i);
+    else if (arg.type == FormatArg::UINT)
+      appendDouble(b, spec, (double)arg.value.u);
+    else
+      throw FormatException();
+  }
+}
+
+/**
+ * Append the integer arg to b in the base spec calls for.  Negative
+ * values are written in hexadecimal or octal as the unsigned value of
+ * the same size that printf would write: that of the argument after
+ * promotion to int, or of the type given by an h or hh modifier.
+ */
+void Format::appendInteger(StringBuilder& b, const Spec& spec,
+                           const FormatArg& arg) {
+  unsigned long long value;
+  bool negative = false;
+  unsigned size = spec.length;
+  if (!size)
+    size = (arg.size < sizeof(int)) ? sizeof(int) : arg.size;
+
+  if (arg.type == FormatArg::INT) {
+    value = (unsigned long long)arg.value.i;
+    negative = arg.value.i < 0;
+  } else if (arg.type == FormatArg::UINT) {
+    value = arg.value.u;
+  } else if (arg.type == FormatArg::CHAR) {
+    value = (unsigned long long)(long long)arg.value.c;
+    negative = arg.value.c < 0;
+  } else {
+    throw FormatException();
+  }
+
+  // the digits, written from the end of buf
+  char buf[24];
+  char* end = buf + sizeof(buf);
+  char* digits = end;
+  char prefix[2];
+  size_t prefixLen = 0;
+
+  if (spec.type == 'x' || spec.type == 'X' || spec.type == 'o') {
+    if (negative && size < sizeof(value))
+      value &= (1ULL << (size * 8)) - 1;
+
+    if (spec.type == 'o') {
+      for (unsigned long long v = value; v; v >>= 3)
+        *--digits = (char)('0' + (v & 7));
+    } else {
+      const char* hex = (spec.type == 'x') ? "0123456789abcdef"
+                                           : "0123456789ABCDEF";
+      for (unsigned long long v = value; v; v >>= 4)
+        *--digits = hex[v & 15];
+      if ((spec.flags & ALTERNATE) && value) {
+        prefix[prefixLen++] = '0';
+        prefix[prefixLen++] = spec.type;
+      }
+    }
+  } else {
+    if (negative) {
+      value = 0ULL - value;
+      prefix[prefixLen++] = '-';
+    } else if (spec.flags & PLUS) {
+      prefix[prefixLen++] = '+';
+    } else if (spec.flags & SPACE) {
+      prefix[prefixLen++] = ' ';
+    }
+
+    if (value) {
+      digits = buf;
+      end = buf + format_uint(buf, value);
+    }
+  }
+
+  // the precision is the minimum number of digits (a zero value has none
+  // if it is 0, but at least one otherwise)
+  size_t len = end - digits;
+  size_t minimum = (spec.precision >= 0) ? (size_t)spec.precision : 1;
+  if (spec.type == 'o' && (spec.flags & ALTERNATE) && len >= minimum)
+    minimum = len + 1;
+  size_t zeros = (minimum > len) ? minimum - len : 0;
+
+  size_t total = prefixLen + zeros + len;
+  size_t pad = (spec.width > 0 && (size_t)spec.width > total) ?
+    spec.width - total : 0;
+
+  if (pad && (spec.flags & ZERO) && !(spec.flags & LEFT) &&
+      spec.precision < 0) {
+    zeros += pad;
+    pad = 0;
+  }
+
+  if (pad && !(spec.flags & LEFT))
+    b.append(' ', pad);
+  b.append(prefix, prefixLen);
+  b.append('0', zeros);
+  b.append(digits, len);
+  if (pad && (spec.flags & LEFT))
+    b.append(' ', pad);
+}
+
+/**
+ * Append value to b with printf, using the conversion, flags, width
+ * and precision of spec.
+ */
+void Format::appendDouble(StringBuilder& b, const Spec& spec, double value) {
+  char format[32];
+  char* p = format;
+  *p++ = '%';
+  if (spec.flags & LEFT)      *p++ = '-';
+  if (spec.flags & PLUS)      *p++ = '+';
+  if (spec.flags & SPACE)     *p++ = ' ';
+  if (spec.flags & ZERO)      *p++ = '0';
+  if (spec.flags & ALTERNATE) *p++ = '#';
+  if (spec.width >= 0)
+    p += format_uint(p, spec.width);
+  if (spec.precision >= 0) {
+    *p++ = '.';
+    p += format_uint(p, spec.precision);
+  }
+  *p++ = spec.type;
+  *p = 0;
+
+  char local[128];
+  int len = snprintf(local, sizeof(local), format, value);
+  if (len < (int)sizeof(local)) {
+    b.append(local, len);
+    return;
+  }
+
+  // very large values, widths or precisions
+  char* buf = static_cast<char*>(malloc(len + 1));
+  if (!buf)
+    throw OutOfMemoryException();
+  snprintf(buf, len + 1, format, value);
+  b.append(buf, len);
+  free(buf);
+}
+
+/**
+ * Append the len bytes at str to b, padded with spaces to the width of
+ * spec.
+ */
+void Format::appendPadded(StringBuilder& b, const Spec& spec,
+                          const char* str, size_t len) {
+  size_t pad = (spec.width > 0 && (size_t)spec.width > len) ?
+    spec.width - len : 0;
+
+  if (pad && !(spec.flags & LEFT))
+    b.append(' ', pad);
+  b.append(str, len);
+  if (pad && (spec.flags & LEFT))
+    b.append(' ', pad);
+}
+
+} // namespace
@@ -0,0 +1,422 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+/**
+ * Rope
+ *
+ * An immutable string made of shared pieces, for very large strings.
+ */
+#include <mcl/Rope.h>
+
+#include <mcl/StringBuilder.h>
+#include <mcl/OutOfBoundsException.h>
+#include <mcl/OutOfMemoryException.h>
+
+#include <string.h>
+
+using namespace mcl;
+
+
+/**
+ * Construct a Rope holding str.  The Rope shares the data of str
+ * (unless it is in a StringArena, in which case it is copied).
+ *
+ * @param str The string to create the Rope from.
+ */
+Rope::Rope(const String& str) : root(leaf(str)) { }
+
+/**
+ * Construct a Rope holding a copy of the null-terminated string str.
+ *
+ * @param str The string to create the Rope from.
+ */
+Rope::Rope(const char* str) : root(leaf(String(str))) { }
+
+/**
+ * Construct a Rope that is a copy of rope.  This takes constant time,
+ * since the copy shares the tree of rope.
+ *
+ * @param rope The rope to copy.
+ */
+Rope::Rope(const Rope& rope) : root(retain(rope.root)) { }
+
+/**
+ * Destructor
+ */
+Rope::~Rope() {
+  release(root);
+}
+
+/**
+ * Return the character at pos.  An OutOfBoundsException is thrown if
+ * pos is not within the Rope.
+ *
+ * @param pos The position of the character (the first is 0).
+ */
+char Rope::charAt(size_t pos) const {
+  size_t len = size();
+  if (pos >= len)
+    throw OutOfBoundsException(0, len - 1, pos);
+
+  const Node* n = root;
+  while (n->height > 0) {
+    if (pos < n->left->size) {
+      n = n->left;
+    } else {
+      pos -= n->left->size;
+      n = n->right;
+    }
+  }
+
+  return n->str.data()[pos];
+}
+
+/**
+ * Return a Rope holding this Rope followed by rope.
+ *
+ * @param rope The rope to append.
+ */
+Rope Rope::concat(const Rope& rope) const {
+  return Rope(join(root, rope.root));
+}
+
+/**
+ * Return the part of this Rope from the given offset to the end.  See
+ * String::substring() for the meaning of the parameters.
+ *
+ * @param offset The position where the substring should begin (the
+ *               first character is 0).
+ */
+Rope Rope::substring(long offset) const {
+  return substring(offset, (offset < 0 ? 0 - offset : size() + offset));
+}
+
+/**
+ * Return the part of this Rope from the given offset up to the
+ * specified length.  See String::substring() for the meaning of the
+ * parameters.
+ *
+ * @param offset The position where the substring should begin (the
+ *               first character is 0).
+ * @param len    The length of the substring.
+ */
+Rope Rope::substring(long offset, long len) const {
+  String::constrain((long)size(), offset, len);
+  if (len == 0)
+    return Rope();
+
+  return Rope(range(root, (size_t)offset, (size_t)(offset + len)));
+}
+
+/**
+ * Return a Rope holding this Rope with rope inserted before the
+ * character at pos.  A pos beyond the end appends rope.
+ *
+ * @param pos  The position to insert rope at.
+ * @param rope The rope to insert.
+ */
+Rope Rope::insert(size_t pos, const Rope& rope) const {
+  if (pos > size())
+    pos = size();
+
+  return substring(0, (long)pos).concat(rope).concat(substring((long)pos));
+}
+
+/**
+ * Return a Rope holding this Rope without the characters from offset
+ * up to the given length.  See String::substring() for the meaning of
+ * the parameters.
+ *
+ * @param offset The position of the first character to remove.
+ * @param len    The number of characters to remove.
+ */
+Rope Rope::remove(long offset, long len) const {
+  String::constrain((long)size(), offset, len);
+
+  return substring(0, offset).concat(substring(offset + len));
+}
+
+/**
+ * Return the contents of this Rope as a String.  A Rope holding a
+ * single leaf returns it without copying, otherwise the String is
+ * assembled with one allocation.
+ */
+String Rope::flatten() const {
+  if (!root)
+    return String();
+  if (root->height == 0)
+    return root->str;
+
+  StringBuilder b(root->size);
+  Iterator it(*this);
+  String piece;
+  while (it.next(piece))
+    b.append(piece);
+
+  return b.toString();
+}
+
+/**
+ * Assign rope to this instance.
+ *
+ * @param rope The rope to assign.
+ */
+Rope& Rope::operator=(const Rope& rope) {
+  Node* old = root;
+  root = retain(rope.root);
+  release(old);
+  return *this;
+}
+
+/**
+ * Assign rope to this instance by taking over its tree.  rope is left
+ * empty.
+ *
+ * @param rope The rope to move.
+ */
+Rope& Rope::operator=(Rope&& rope) {
+  if (&rope != this) {
+    release(root);
+    root = rope.root;
+    rope.root = 0;
+  }
+  return *this;
+}
+
+/**
+ * Create a leaf holding str, or return 0 if str is empty.  Data in a
+ * StringArena is copied out of it.
+ */
+Rope::Node* Rope::leaf(const String& str) {
+  if (str.size() == 0)
+    return 0;
+
+  Node* n = new Node;
+  if (!n)
+    throw OutOfMemoryException();
+
+  n->refCount.store(1, MEMORY_RELAXED);
+  n->size = str.size();
+  n->height = 0;
+  n->left = 0;
+  n->right = 0;
+  n->str = str;
+
+  // a rope may outlive any StringArena its pieces were made in
+  n->str.promote();
+
+  return n;
+}
+
+/**
+ * Create a node concatenating left and right, which must both be
+ * non-empty and differ in height by no more than one.  References to
+ * both are added.
+ */
+Rope::Node* Rope::node(Node* left, Node* right) {
+  Node* n = new Node;
+  if (!n)
+    throw OutOfMemoryException();
+
+  n->refCount.store(1, MEMORY_RELAXED);
+  n->size = left->size + right->size;
+  n->height = (left->height > right->height ? left->height : right->height) + 1;
+  n->left = retain(left);
+  n->right = retain(right);
+
+  return n;
+}
+
+/**
+ * Return a new reference to a balanced tree concatenating left and
+ * right (either of which may be 0), in time proportional to the
+ * difference in their heights.  The taller tree is descended along
+ * its inner edge until a subtree of about the height of the other is
+ * found, and the path back up is rebuilt with new nodes.
+ */
+Rope::Node* Rope::join(Node* left, Node* right) {
+  if (!left)
+    return retain(right);
+  if (!right)
+    return retain(left);
+
+  // combine small leaves rather than building a node
+  if (left->height == 0 && right->height == 0 &&
+      left->size + right->size <= LEAF_MERGE) {
+    char buf[LEAF_MERGE];
+    memcpy(buf, left->str.data(), left->size);
+    memcpy(buf + left->size, right->str.data(), right->size);
+    return leaf(String(buf, left->size + right->size));
+  }
+
+  int hl = left->height;
+  int hr = right->height;
+  Node* joined;
+  Node* result;
+
+  if (hl > hr + 1) {
+    joined = join(left->right, right);
+    result = joinBalanced(left->left, joined);
+  } else if (hr > hl + 1) {
+    joined = join(left, right->left);
+    result = joinBalanced(joined, right->right);
+  } else {
+    return node(left, right);
+  }
+
+  release(joined);
+  return result;
+}
+
+/**
+ * Return a new reference to a node concatenating left and right, whose
+ * heights differ by no more than two, rotating the taller one if that
+ * is necessary to keep the tree balanced.
+ */
+Rope::Node* Rope::joinBalanced(Node* left, Node* right) {
+  int hl = left->height;
+  int hr = right->height;
+  Node* inner;
+  Node* outer;
+  Node* result;
+
+  if (hr > hl + 1) {
+    if (height(right->left) <= height(right->right)) {
+      // single rotation
+      inner = node(left, right->left);
+      result = node(inner, right->right);
+      release(inner);
+    } else {
+      // double rotation
+      Node* mid = right->left;
+      inner = node(left, mid->left);
+      outer = node(mid->right, right->right);
+      result = node(inner, outer);
+      release(inner);
+      release(outer);
+    }
+  } else if (hl > hr + 1) {
+    if (height(left->right) <= height(left->left)) {
+      inner = node(left->right, right);
+      result = node(left->left, inner);
+      release(inner);
+    } else {
+      Node* mid = left->right;
+      outer = node(left->left, mid->left);
+      inner = node(mid->right, right);
+      result = node(outer, inner);
+      release(inner);
+      release(outer);
+    }
+  } else {
+    result = node(left, right);
+  }
+
+  return result;
+}
+
+/**
+ * Return a new reference to a tree holding the characters of n from
+ * position from up to (but not including) to, which must be a
+ * non-empty range within n.
+ */
+Rope::Node* Rope::range(Node* n, size_t from, size_t to) {
+  if (from == 0 && to == n->size)
+    return retain(n);
+
+  if (n->height == 0)
+    return leaf(n->str.slice((long)from, (long)(to - from)));
+
+  size_t split = n->left->size;
+  if (to <= split)
+    return range(n->left, from, to);
+  if (from >= split)
+    return range(n->right, from - split, to - split);
+
+  Node* left = range(n->left, from, split);
+  Node* right = range(n->right, 0, to - split);
+  Node* result = join(left, right);
+  release(left);
+  release(right);
+
+  return result;
+}
+
+/**
+ * Remove a reference to n (if it is not null), freeing it and
+ * releasing its children when none remain.
+ */
+void Rope::release(Node* n) {
+  while (n && n->refCount.fetchAdd(-1, MEMORY_ACQ_REL) == 1) {
+    Node* right = n->right;
+    release(n->left);
+    delete n;
+    // continue with the right child rather than recursing
+    n = right;
+  }
+}
+
+
+/**
+ * Construct an iterator positioned at the beginning of rope.
+ *
+ * @param rope The rope to visit.
+ */
+Rope::Iterator::Iterator(const Rope& rope) : rope(rope), top(0), pos(0) {
+  if (rope.root)
+    stack[top++] = rope.root;
+}
+
+/**
+ * Return the next character.  An OutOfBoundsException is thrown if
+ * every character has already been returned (see hasNext()).
+ */
+char Rope::Iterator::nextChar() {
+  if (pos == chunk.size()) {
+    if (top == 0) {
+      size_t len = rope.size();
+      throw OutOfBoundsException(0, len - 1, len);
+    }
+    advance();
+  }
+
+  return chunk.data()[pos++];
+}
+
+/**
+ * Assign the next piece of the Rope (the rest of the current leaf, or
+ * the next leaf) to piece and return true, or return false (leaving
+ * piece unchanged) if the whole Rope has been visited.  Pieces share
+ * the data of the Rope.
+ *
+ * @param piece The string to assign the piece to.
+ */
+bool Rope::Iterator::next(String& piece) {
+  if (pos == chunk.size()) {
+    if (top == 0)
+      return false;
+    advance();
+  }
+
+  if (pos == 0)
+    piece = chunk;
+  else
+    piece = chunk.slice((long)pos, (long)(chunk.size() - pos));
+  pos = chunk.size();
+
+  return true;
+}
+
+/**
+ * Move to the next leaf.
+ */
+void Rope::Iterator::advance() {
+  const Node* n = stack[--top];
+  while (n->height > 0) {
+    stack[top++] = n->right;
+    n = n->left;
+  }
+
+  chunk = n->str;
+  pos = 0;
+}
@@ -9,25 +9,143 @@
 #include <mcl/String.h>
 
 #include <mcl/hash_functions.h>
+#include <mcl/memory_functions.h>
+#include <mcl/number_functions.h>
 #include <mcl/InvalidReferenceCountException.h>
+#include <mcl/IOException.h>
 #include <mcl/OutOfMemoryException.h>
+#include <mcl/Vector.h>
 
+#include <errno.h>
+#include <stdio.h>
 #include <string.h>
 
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <mutex>
+#include <vector>
+
 using namespace mcl;
 
 namespace mcl {
-  // global empty string
-  StringRef EMPTY_STRING(0, (char*) "", true);
+  // the reference of strings allocated in an arena
+  StringRef ARENA_STRING(0, 0, 0, 0, true, true);
+
+  // the owner of references created by each thread
+  _MCL_THREAD_LOCAL StringRefOwner* StringRef::currentOwner = 0;
+}
+
+namespace {
+
+/**
+ * The complete state of an owner of biased references.  Owners are
+ * never freed: when a thread stops using biased reference counting its
+ * owner becomes inactive and is later reused by another thread, which
+ * takes over the counts of any references it still owns.
+ */
+struct OwnerRecord : public StringRefOwner {
+  /** Guards queue and active */
+  std::mutex lock;
+  /** References whose shared count went negative, awaiting a merge */
+  std::vector<StringRef*> queue;
+  /** Set while a thread is using this owner */
+  bool active;
+  /** The next inactive owner */
+  OwnerRecord* nextFree;
+};
+
+/** Inactive owners available for reuse */
+std::mutex freeOwnersLock;
+OwnerRecord* freeOwners = 0;
+
+/**
+ * Fold the owner's count of ref into its shared count, after which all
+ * of its references are counted atomically.  Either the owner thread
+ * or (for an inactive owner, holding its lock) any thread may do this.
+ * The reference is freed if no references remain.
+ */
+void mergeReference(StringRef* ref) {
+  int biased = ref->biasedCount;
+  ref->biasedCount = 0;
+
+  int countWas = ref->refCount.load(MEMORY_RELAXED);
+  int count;
+  do {
+    count = (countWas + biased * StringRef::BIAS_UNIT) | StringRef::BIAS_MERGED;
+    count &= ~StringRef::BIAS_QUEUED;
+  } while (!ref->refCount.compareExchange(countWas, count, MEMORY_ACQ_REL));
+
+  if (count < StringRef::BIAS_UNIT)
+    StringRef::destroy(ref);
+}
+
+/**
+ * Stops biased reference counting for the current thread when the
+ * thread exits.
+ */
+struct OwnerExit {
+  bool armed;
+  ~OwnerExit() { if (armed) String::useBiasedReferences(false); }
+};
+
+thread_local OwnerExit ownerExit;
+
+#ifndef WIN32
+/**
+ * Deleter for the data of a file mapped by String::fromFile().
+ */
+void unmapFile(char* data, size_t size, void*) {
+  munmap(data, size);
+}
+#endif
+
+} // namespace
+
+
+/**
+ * Allocate a StringRef referring to the size bytes of data, which the
+ * new reference takes over: deleter is called with data, size and
+ * deleterContext once no references remain.  If the StringRef cannot
+ * be allocated, the data is released immediately and an
+ * OutOfMemoryException is thrown.  Like create(), the StringRef comes
+ * from the current StringAllocator, and the reference is owned by the
+ * current thread if that thread uses biased reference counting.
+ */
+StringRef* StringRef::adopt(char* data, size_t size, Deleter deleter,
+                            void* deleterContext, bool terminated) {
+  StringAllocator* allocator = StringAllocator::current();
+  void* block = allocator->allocate(sizeof(StringRef));
+  if (!block) {
+    if (deleter)
+      deleter(data, size, deleterContext);
+    throw OutOfMemoryException();
+  }
+
+  StringRef* ref = new (block) StringRef(size, data, deleter, deleterContext,
+                                         terminated);
+  ref->allocator = allocator;
+
+  if (currentOwner) {
+    ref->owner = currentOwner;
+    ref->biasedCount = 1;
+    ref->refCount.store(0, MEMORY_RELAXED);
+  }
+
+  return ref;
 }
 
 
 /**
  * Construct an empty String.
  */
-String::String() : ref(&EMPTY_STRING) {
-  // the empty string never goes out of scope
-  acquireReference(ref);
+String::String() {
+  // the empty string is always stored locally
+  setLocal((size_t)0);
 }
 
 /**
@@ -35,7 +153,8 @@ String::String() : ref(&EMPTY_STRING) {
  *
  * @param str The string to copy.
  */
-String::String(const String& str) : ref(0) {
+String::String(const String& str) {
+  setLocal((size_t)0);
   assign(str);
 }
 
@@ -44,7 +163,8 @@ String::String(const String& str) : ref(0) {
  *
  * @param str The null-terminated string to create a copy of.
  */
-String::String(const char* str) : ref(0) {
+String::String(const char* str) {
+  setLocal((size_t)0);
   assign(str);
 }
 
@@ -58,7 +178,8 @@ String::String(const char* str) : ref(0) {
  * @param offset The position in str where the substring should begin (the
  *               first character is 0).
  */
-String::String(const String& str, long offset) : ref(0) {
+String::String(const String& str, long offset) {
+  setLocal((size_t)0);
   assign(str, offset);
 }
 
@@ -73,7 +194,8 @@ String::String(const String& str, long offset) : ref(0) {
  *               first character is 0).
  * @param len    The length of the new substring.
  */
-String::String(const String& str, long offset, long len) : ref(0) {
+String::String(const String& str, long offset, long len) {
+  setLocal((size_t)0);
   assign(str, offset, len);
 }
 
@@ -85,7 +207,8 @@ String::String(const String& str, long offset, long len) : ref(0) {
  * @param str    The string to create the substring from.
  * @param len    The length of the  new substring
  */
-String::String(const char* str, size_t len) : ref(0) {
+String::String(const char* str, size_t len) {
+  setLocal((size_t)0);
   assign(str, len);
 }
 
@@ -98,28 +221,193 @@ String::String(const char* str, size_t len) : ref(0) {
  * @param repeat The optional parameter specifying the number of times
  *               to repeat c.
  */
-String::String(char c, size_t repeat) : ref(0) {
+String::String(char c, size_t repeat) {
+  setLocal((size_t)0);
   assign(c, repeat);
 }
 
+/**
+ * Construct a String that takes over len bytes of data allocated
+ * elsewhere, without copying them.  The data must not change while
+ * the String (or any copy of it) exists; once the last one is gone,
+ * deleter is called with data, len and context to release it.  A
+ * deleter of 0 leaves the data alone (for data that outlives every
+ * String, though literal() is cheaper for that).
+ *
+ * Since the byte following the data may not belong to it, the String
+ * is only null-terminated if terminated is set, in which case
+ * data[len] must be a null character.  Short strings are copied
+ * instead (they are stored locally, see LOCAL_CAPACITY), and their
+ * data is released immediately.
+ *
+ * <code>
+ * char* buf = (char*)malloc(len);
+ * fread(buf, 1, len, fp);
+ * String contents(buf, len, [](char* data, size_t, void*) { free(data); });
+ * </code>
+ *
+ * @param data       The data to take over.
+ * @param len        The number of bytes in data.
+ * @param deleter    The function releasing data.
+ * @param context    A value passed to deleter.
+ * @param terminated Set if data is followed by a null character.
+ */
+String::String(char* data, size_t len, StringRef::Deleter deleter,
+               void* context, bool terminated) {
+  if (len <= LOCAL_CAPACITY) {
+    setLocal(data, len);
+    if (deleter)
+      deleter(data, len, context);
+    return;
+  }
+
+  setShared(StringRef::adopt(data, len, deleter, context, terminated));
+}
+
+/**
+ * Return a String holding the contents of the file at path.  The file
+ * is mapped into memory read-only rather than read, so no copy of it
+ * is made and its pages are only loaded as they are used; it is
+ * unmapped once no String refers to it any more.  The file must not be
+ * modified or truncated while it is mapped.  The String is
+ * null-terminated unless the file exactly fills its last page (the
+ * rest of the page reads as zeros).  Under Windows the file is read
+ * into a buffer the String takes over instead.
+ *
+ * An IOException is thrown if the file cannot be opened or mapped.
+ *
+ * @param path The name of the file.
+ */
+String String::fromFile(const char* path) {
+#ifndef WIN32
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    throw IOException(errno);
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    int code = errno;
+    close(fd);
+    throw IOException(code);
+  }
+
+  if ((unsigned long long)st.st_size > (size_t)-1) {
+    close(fd);
+    throw OutOfMemoryException();
+  }
+
+  size_t len = (size_t)st.st_size;
+  if (len == 0) {
+    close(fd);
+    return String();
+  }
+
+  void* data = mmap(0, len, PROT_READ, MAP_PRIVATE, fd, 0);
+  int code = errno;
+  close(fd);
+  if (data == MAP_FAILED)
+    throw IOException(code);
+
+  bool terminated = (len % (size_t)sysconf(_SC_PAGESIZE)) != 0;
+  return String((char*)data, len, unmapFile, 0, terminated);
+#else
+  FILE* fp = fopen(path, "rb");
+  if (!fp)
+    throw IOException(errno);
+
+  long len = -1;
+  if (fseek(fp, 0, SEEK_END) == 0)
+    len = ftell(fp);
+  if (len < 0 || fseek(fp, 0, SEEK_SET) != 0) {
+    int code = errno;
+    fclose(fp);
+    throw IOException(code);
+  }
+
+  char* data = new (std::nothrow) char[len + 1];
+  if (!data) {
+    fclose(fp);
+    throw OutOfMemoryException();
+  }
+
+  size_t got = fread(data, 1, (size_t)len, fp);
+  int code = errno;
+  fclose(fp);
+  if (got != (size_t)len) {
+    delete [] data;
+    throw IOException(code);
+  }
+
+  data[len] = 0;
+  return String(data, (size_t)len, StringRef::deleteArray, 0, true);
+#endif
+}
+
+/**
+ * Return the decimal representation of value.
+ *
+ * @param value The number to convert.
+ */
+String String::fromInt(long long value) {
+  char buf[NUMBER_BUFFER_SIZE];
+  return String(buf, format_int(buf, value));
+}
+
+/**
+ * Return the decimal representation of value.
+ *
+ * @param value The number to convert.
+ */
+String String::fromUInt(unsigned long long value) {
+  char buf[NUMBER_BUFFER_SIZE];
+  return String(buf, format_uint(buf, value));
+}
+
+/**
+ * Return the shortest decimal representation of value that
+ * toDouble() converts back to exactly the same value.  See
+ * format_double() for the forms it takes.
+ *
+ * @param value The number to convert.
+ */
+String String::fromDouble(double value) {
+  char buf[NUMBER_BUFFER_SIZE];
+  return String(buf, format_double(buf, value));
+}
+
 /**
  * Destructor
  */
 String::~String() {
-  if (ref)
-    release();
+  release();
 }
 
 /**
- * Return the hash value of the provided string
+ * Return the hash value of the provided string.  The value for a string
+ * held in a StringRef is computed once and then kept in the StringRef.
  */
 size_t String::hash(const String& str) {
-  return hash_string(str.ref->data, str.ref->size);
+  if (!str.isCounted())
+    return hash_string(str.data(), str.size());
+
+  // only the hash of all of the data is kept (not that of a slice)
+  StringRef* ref = str.rep.shared.ref;
+  if (str.rep.shared.len != ref->size)
+    return hash_string(str.rep.shared.ptr, str.rep.shared.len);
+
+  size_t h = ref->hashCode.load(MEMORY_RELAXED);
+  if (!h) {
+    h = hash_string(ref->data, ref->size);
+    ref->hashCode.store(h, MEMORY_RELAXED);
+  }
+
+  return h;
 }
 
 /**
  * Create a substring of this String from the given offset to the end of
- * the string. Returns a new String.
+ * the string. Returns a new String.  The substring shares the data of
+ * this String instead of copying it where possible.
  *
  * The value for <tt>offset</tt> may be positive or negative. A positive
  * value begins the substring that many characters from the beginning. A
@@ -149,7 +437,11 @@ String String::substring(long offset) const {
 
 /**
  * Create a substring of this String from the given offset up to the
- * specified length. Returns a new String.
+ * specified length. Returns a new String.  The data of a substring is
+ * always null-terminated, so unless the substring happens to end where
+ * a null character already is (such as at the end of this String) it
+ * contains a copy of the data.  See slice() for an alternative that
+ * never copies.
  *
  * The value for <tt>offset</tt> may be positive or negative. A positive
  * value begins the substring that many characters from the beginning. A
@@ -183,21 +475,372 @@ String String::substring(long offset, long len) const {
   return String(*this, offset, len);
 }
 
+/**
+ * Create a slice of this String, beginning at offset and including
+ * len characters.  Unlike substring(), a slice always shares the data
+ * of this String rather than copying it, even when the slice ends
+ * before the end of this string.  This makes slicing a constant-time
+ * operation, but it means the data of a slice is not necessarily
+ * null-terminated (see isTerminated()).  Use terminated() to obtain a
+ * null-terminated copy before passing a slice to a C routine, and
+ * compact() to stop a small slice from holding on to the data of a
+ * much larger string.
+ *
+ * The offset and len parameters are interpreted the same way as they
+ * are for substring().
+ *
+ * @param offset The position where the slice should begin (the first
+ *               character is 0).
+ * @param len    The length of the slice.
+ */
+String String::slice(long offset, long len) const {
+  constrain((long)size(), offset, len);
+
+  String result;
+  result.assignSlice(*this, (size_t)offset, (size_t)len, false);
+  return result;
+}
+
+/**
+ * Return a null-terminated version of this String.  This is the string
+ * itself if its data is already terminated, or a copy otherwise.
+ */
+String String::terminated() const {
+  if (isTerminated())
+    return *this;
+
+  return String(data(), size());
+}
+
+/**
+ * If this String is a slice of a larger block of data, replace it with
+ * a copy of just its own characters.  This allows the larger block to
+ * be freed once nothing else refers to it.
+ */
+void String::compact() {
+  // the data of an arena is only freed all at once
+  if (!isCounted() || inArena())
+    return;
+
+  StringRef* ref = rep.shared.ref;
+  if (rep.shared.ptr != ref->data || rep.shared.len != ref->size)
+    assign(rep.shared.ptr, rep.shared.len);
+}
+
+/**
+ * Make the data of this String immortal: it will never be freed, and
+ * copying or destroying any String that shares it will no longer
+ * change its reference count.  This is intended for values that are
+ * created once and then shared by many threads for the life of the
+ * program (such as keys read from a configuration file), whose
+ * reference count would otherwise be contended.  The memory is never
+ * reclaimed, so it should not be used for values that come and go.
+ *
+ * A string stored locally, or referring to a literal, is already free
+ * of reference counting and is left unchanged.  A string in a
+ * StringArena is first promoted (see promote()).  A slice is first
+ * compacted so that only its own characters are kept, and an interned
+ * string is first copied (a StringPool must be able to tell when its
+ * entries are no longer used).
+ */
+void String::makeImmortal() {
+  if (!isCounted())
+    return;
+
+  promote();
+  compact();
+  if (isCounted() && rep.shared.ref->pool)
+    assign(rep.shared.ptr, rep.shared.len);
+
+  if (isCounted())
+    rep.shared.ref->immortal.store(true, MEMORY_RELAXED);
+}
+
+/**
+ * Return the value of the decimal integer this String holds, which may
+ * begin with a plus or minus sign.  A NumberFormatException is thrown
+ * if it holds anything else (including white space), and an
+ * IntegerWrapException if the value does not fit in a long long.
+ */
+long long String::toInt64() const {
+  return parse_int(data(), size());
+}
+
+/**
+ * Return the value of the unsigned decimal integer this String holds,
+ * which may begin with a plus sign.  A NumberFormatException is thrown
+ * if it holds anything else (including white space), and an
+ * IntegerWrapException if the value does not fit in an unsigned long
+ * long.
+ */
+unsigned long long String::toUInt64() const {
+  return parse_uint(data(), size());
+}
+
+/**
+ * Return the value of the floating-point number this String holds.
+ * A NumberFormatException is thrown if it holds anything else
+ * (including white space), or a number too large for a double.  See
+ * parse_double() for the forms accepted.
+ */
+double String::toDouble() const {
+  return parse_double(data(), size());
+}
+
+/**
+ * If the data of this String is in a StringArena, replace it with a
+ * copy allocated as usual (in a StringRef), so that the String remains
+ * valid once the arena is destroyed.  Other Strings are unchanged.
+ * The copy is never allocated from an arena, even if one is active.
+ */
+void String::promote() {
+  if (!inArena())
+    return;
+
+  // arena strings are never short enough to be stored locally
+  StringRef* ref = StringRef::create(rep.shared.len);
+  memcpy(ref->data, rep.shared.ptr, rep.shared.len);
+  setShared(ref);
+}
+
+/**
+ * Turn biased reference counting on or off for the current thread.
+ *
+ * When it is on, each StringRef this thread creates is owned by the
+ * thread, which then acquires and releases references to it with
+ * ordinary (non-atomic) arithmetic.  Other threads still count their
+ * references with atomic operations.  This makes copying and
+ * destroying strings cheaper for a thread whose strings are mostly
+ * used on that thread, and costs more only for strings that are
+ * released on another thread than the one that created them.  Such a
+ * string is handed back to its owner, which finishes releasing it the
+ * next time it releases a string of its own.  A thread whose strings
+ * are routinely destroyed by other threads should leave this off.
+ *
+ * Turning it off (which happens automatically when the thread exits)
+ * finishes releasing any strings handed back to the thread.  Strings
+ * created while it was on remain valid and may be used by any thread.
+ *
+ * @param enable Whether the current thread should use biased reference
+ *               counting.
+ */
+void String::useBiasedReferences(bool enable) {
+  OwnerRecord* owner = static_cast<OwnerRecord*>(StringRef::currentOwner);
+
+  if (enable && !owner) {
+    {
+      std::lock_guard<std::mutex> guard(freeOwnersLock);
+      owner = freeOwners;
+      if (owner)
+        freeOwners = owner->nextFree;
+    }
+    if (!owner)
+      owner = new OwnerRecord;
+
+    {
+      std::lock_guard<std::mutex> guard(owner->lock);
+      owner->active = true;
+      owner->nextFree = 0;
+    }
+
+    StringRef::currentOwner = owner;
+    ownerExit.armed = true;
+  }
+
+  if (!enable && owner) {
+    {
+      std::lock_guard<std::mutex> guard(owner->lock);
+      for (size_t i = 0; i < owner->queue.size(); i++)
+        mergeReference(owner->queue[i]);
+      owner->queue.clear();
+      owner->pending.store(false, MEMORY_RELAXED);
+      owner->active = false;
+    }
+
+    StringRef::currentOwner = 0;
+
+    std::lock_guard<std::mutex> guard(freeOwnersLock);
+    owner->nextFree = freeOwners;
+    freeOwners = owner;
+  }
+}
+
+/**
+ * Return the position of the first occurrence of the character c in
+ * this String, or -1 if it does not occur.  The search examines the
+ * whole string, including any embedded nulls.
+ *
+ * @param c    The character to find.
+ * @param from The position to begin searching at.  As with substring(),
+ *             a negative value counts back from the end of the string.
+ */
+long String::find(char c, long from) const {
+  long len = 0;
+  constrain((long)size(), from, len);
+
+  const char* d = data();
+  const char* found = (const char*)mem_find_char(d + from, size() - from, c);
+
+  return found ? (long)(found - d) : -1;
+}
+
+/**
+ * Return the position of the first occurrence of str in this String,
+ * or -1 if it does not occur.  An empty str is found at the starting
+ * position.
+ *
+ * @param str  The string to find.
+ * @param from The position to begin searching at.  As with substring(),
+ *             a negative value counts back from the end of the string.
+ */
+long String::find(const String& str, long from) const {
+  long len = 0;
+  constrain((long)size(), from, len);
+
+  const char* d = data();
+  const char* found = (const char*)mem_find(d + from, size() - from,
+                                            str.data(), str.size());
+
+  return found ? (long)(found - d) : -1;
+}
+
+/**
+ * Return the position of the last occurrence of the character c in
+ * this String, or -1 if it does not occur.
+ *
+ * @param c The character to find.
+ */
+long String::rfind(char c) const {
+  const char* d = data();
+  const char* found = (const char*)mem_rfind_char(d, size(), c);
+
+  return found ? (long)(found - d) : -1;
+}
+
+/**
+ * Return the position of the last occurrence of str in this String,
+ * or -1 if it does not occur.  An empty str is found at the end of
+ * this String.
+ *
+ * @param str The string to find.
+ */
+long String::rfind(const String& str) const {
+  const char* d = data();
+  const char* found = (const char*)mem_rfind(d, size(), str.data(), str.size());
+
+  return found ? (long)(found - d) : -1;
+}
+
+/**
+ * Return true if this String begins with str.
+ *
+ * @param str The prefix to test for.
+ */
+bool String::startsWith(const String& str) const {
+  size_t len = str.size();
+  return len <= size() && mem_equal(data(), str.data(), len);
+}
+
+/**
+ * Return true if this String ends with str.
+ *
+ * @param str The suffix to test for.
+ */
+bool String::endsWith(const String& str) const {
+  size_t len = str.size();
+  return len <= size() && mem_equal(data() + size() - len, str.data(), len);
+}
+
+/**
+ * Return the number of times the character c occurs in this String.
+ *
+ * @param c The character to count.
+ */
+size_t String::count(char c) const {
+  return mem_count_char(data(), size(), c);
+}
+
+/**
+ * Return the number of non-overlapping occurrences of str in this
+ * String.  (For example, "aaaa" contains "aa" twice.)  An empty str is
+ * never counted.
+ *
+ * @param str The string to count.
+ */
+size_t String::count(const String& str) const {
+  size_t len = str.size();
+  if (len == 1)
+    return count(str.data()[0]);
+  if (len == 0)
+    return 0;
+
+  const char* d = data();
+  const char* end = d + size();
+  size_t total = 0;
+
+  for (;;) {
+    const char* found = (const char*)mem_find(d, end - d, str.data(), len);
+    if (!found)
+      return total;
+    total++;
+    d = found + len;
+  }
+}
+
+/**
+ * Split this String into the fields separated by the character delim,
+ * appending them to fields.  Every delimiter separates two fields, so
+ * adjacent delimiters produce an empty field and a string without any
+ * delimiter is a single field.  (For example, splitting "a,,b," on ','
+ * produces "a", "", "b" and "".)  Returns the number of fields
+ * appended.
+ *
+ * The fields are slices of this String (see slice()): they share its
+ * data instead of copying it, so they may not be null-terminated.
+ * Another form of split() takes a function object to be called with
+ * each field instead of a Vector, and StringTokenizer produces the
+ * fields one at a time.
+ *
+ * @param delim  The character separating fields.
+ * @param fields The Vector to append the fields to.
+ */
+size_t String::split(char delim, Vector<String>& fields) const {
+  return split(delim, [&fields](String& field) {
+      fields.append(std::move(field));
+    });
+}
+
+/**
+ * Split this String into the fields separated by the string delim,
+ * appending them to fields.  This behaves like split(char, Vector&),
+ * except that an empty delim leaves this String as a single field.
+ *
+ * @param delim  The string separating fields.
+ * @param fields The Vector to append the fields to.
+ */
+size_t String::split(const String& delim, Vector<String>& fields) const {
+  return split(delim, [&fields](String& field) {
+      fields.append(std::move(field));
+    });
+}
+
 /**
  * Assign the string str to this instance.
  *
  * @param str The string to assign.
  */
 void String::assign(const String& str) {
-  // release any current string
-  if (ref)
-    release();
+  if (&str == this)
+    return;
 
   // add a reference to str's data
-  if (acquireReference(str.ref))
-    ref = str.ref;
-  else
+  if (str.isCounted() && !acquireReference(str.rep.shared.ref))
     throw InvalidReferenceCountException();
+
+  // release any current string
+  release();
+
+  rep = str.rep;
 }
 
 /**
@@ -206,24 +849,7 @@ void String::assign(const String& str) {
  * @param str The string to assign.
  */
 void String::assign(const char* str) {
-  // release any current string
-  if (ref)
-    release();
-
-  // create a new reference
-  ref = new StringRef(0, 0);
-  if (!ref)
-    throw OutOfMemoryException();
-
-  // allocate memory for the string
-  size_t len = strlen(str);
-  ref->data = new char[len + 1];
-  if (! ref->data)
-    throw OutOfMemoryException();
-
-  // copy the string
-  memcpy(ref->data, str, len + 1);
-  ref->size = len;
+  assign(str, strlen(str));
 }
 
 /**
@@ -239,48 +865,8 @@ void String::assign(const char* str) {
  * @param len    The number of characters from str to include.
  */
 void String::assign(const String& str, long offset, long len) {
-  // release any current string
-  if (ref)
-    release();
-  
-  // for negative parameters, calculate the real values
-  long strSize = (long)str.size();
-  if (offset < 0)
-    offset += strSize;
-  if (len < 0)
-    len += strSize - offset;
-  
-  // constrain to boundaries
-  if (offset < 0)
-    offset = 0;
-  if (offset > strSize)
-    offset = strSize;
-  if (len > strSize - offset)
-    len = strSize - offset;
-  if (len < 0)
-    len = 0;
-
-  // zero-length strings are a special case
-  if (len == 0) {
-    ref = &EMPTY_STRING;
-    acquireReference(ref);
-    return;
-  }
-
-  // create a new reference
-  ref = new StringRef(0, 0);
-  if (!ref)
-    throw OutOfMemoryException();
-
-  // allocate memory for the string
-  ref->data = new char[len + 1];
-  if (! ref->data)
-    throw OutOfMemoryException();
-
-  // copy the string
-  memcpy(ref->data, &(str.ref->data[offset]), len);
-  ref->data[len] = 0; // terminate it
-  ref->size = len;
+  constrain((long)str.size(), offset, len);
+  assignSlice(str, (size_t)offset, (size_t)len, true);
 }
 
 /**
@@ -292,24 +878,34 @@ void String::assign(const String& str, long offset, long len) {
  * @param len    The length of the  new substring
  */
 void String::assign(const char* str, size_t len) {
-  // release any current string
-  if (ref)
+  // short strings are copied in place
+  if (len <= LOCAL_CAPACITY) {
+    // str may point into our own data, so it has to be copied first
+    char buf[LOCAL_CAPACITY];
+    memcpy(buf, str, len);
     release();
+    setLocal(buf, len);
+    return;
+  }
 
-  // create a new reference
-  ref = new StringRef(0, 0);
-  if (!ref)
-    throw OutOfMemoryException();
-
-  // allocate memory for the string
-  ref->data = new char[len + 1];
-  if (! ref->data)
-    throw OutOfMemoryException();
+  // take the space for the string from an active arena, or create a
+  // new reference with room for it (either way before releasing any
+  // current string, which str may be a part of)
+  StringArena* arena = StringArena::current();
+  if (arena) {
+    char* p = arena->allocate(len + 1);
+    memcpy(p, str, len);
+    p[len] = 0;
+    release();
+    setArena(p, len);
+    return;
+  }
 
-  // copy the string
+  StringRef* ref = StringRef::create(len);
   memcpy(ref->data, str, len);
-  ref->data[len] = 0; // terminate it
-  ref->size = len;
+
+  release();
+  setShared(ref);
 }
 
 /**
@@ -322,29 +918,14 @@ void String::assign(const char* str, size_t len) {
  *               of times to repeat c.
  */
 void String::assign(char c, size_t repeat) {
-  // release any current string
-  if (ref)
-    release();
-
-  // create a new reference
-  ref = new StringRef(0, 0);
-  if (!ref)
-    throw OutOfMemoryException();
-
-  // allocate memory for the string
-  ref->data = new char[repeat + 1];
-  if (! ref->data)
-      throw OutOfMemoryException();
-
-  // copy the string
-  memset(ref->data, c, repeat);
-  ref->data[repeat] = 0; // terminate it
-  ref->size = repeat;
+  memset(allocate(repeat), c, repeat);
 }
 
 /**
- * Compares this string to str.  This uses the standard C library
- * routines, so it does not work with embedded nulls.  The return
+ * Compares this string to str.  Strings are compared byte by byte
+ * (as unsigned values) for the length of the shorter string, so
+ * embedded nulls are compared like any other character.  If one string
+ * is a prefix of the other, the shorter one is less.  The return
  * values are as follows:
  *
  *  - this <  str : a value less than 0
@@ -354,31 +935,192 @@ void String::assign(char c, size_t repeat) {
  * @param str  The string to compare.
  */
 int String::compare(const String& str) const {
-  return strcmp(data(), str);
+  return compare(str.data(), str.size());
 }
 
 /**
- * Compares this string to str.  This uses the standard C library
- * routines, so it does not work with embedded nulls.  The return
- * values are as follows:
- *
- *  - this <  str : a value less than 0
- *  - this == str : 0
- *  - this >  str : a value greater than 0
+ * Compares this string to the null-terminated string str.  See
+ * compare(const String&) for details.  (A String containing an
+ * embedded null compares greater than the C string prefix before
+ * the null.)
  *
  * @param str  The string to compare.
  */
 int String::compare(const char* str) const {
-  return strcmp(data(), str);
+  return compare(str, strlen(str));
+}
+
+/**
+ * Compares this string to the len bytes of data at str.
+ */
+int String::compare(const char* str, size_t len) const {
+  const char* d = data();
+  size_t dLen = size();
+
+  if (d == str && dLen == len)
+    return 0;
+
+  int result = mem_compare(d, str, dLen < len ? dLen : len);
+  if (result)
+    return result;
+
+  return (dLen < len) ? -1 : (dLen > len ? 1 : 0);
+}
+
+/**
+ * Assign the len characters of str beginning at offset (which must
+ * already be within bounds) to this instance.  The data is shared with
+ * str whenever that is possible and worthwhile, otherwise it is copied.
+ * If terminated is set, data is only shared when the result remains
+ * null-terminated.
+ */
+void String::assignSlice(const String& str, size_t offset, size_t len,
+                         bool terminated) {
+  const char* ptr = str.data() + offset;
+
+  if (len <= LOCAL_CAPACITY || str.isLocal() ||
+      (terminated && !str.isTerminatedAt(offset + len))) {
+    assign(ptr, len);
+    return;
+  }
+
+  // share str's data (acquired first, since str may be this instance)
+  StringRef* ref = str.rep.shared.ref;
+  if (ref && !acquireReference(ref))
+    throw InvalidReferenceCountException();
+
+  release();
+
+  rep.shared.ref = ref;
+  rep.shared.ptr = ptr;
+  rep.shared.len = len;
+}
+
+/**
+ * Convert possibly negative substring parameters into an offset and
+ * length that fall within a string of strSize characters.  See
+ * substring() for the meaning of the parameters.
+ */
+void String::constrain(long strSize, long& offset, long& len) {
+  // for negative parameters, calculate the real values
+  if (offset < 0)
+    offset += strSize;
+  if (len < 0)
+    len += strSize - offset;
+  
+  // constrain to boundaries
+  if (offset < 0)
+    offset = 0;
+  if (offset > strSize)
+    offset = strSize;
+  if (len > strSize - offset)
+    len = strSize - offset;
+  if (len < 0)
+    len = 0;
+}
+
+/**
+ * Release any current string and make room for a new one of len
+ * characters, returning the (terminated) space to fill in.
+ */
+char* String::allocate(size_t len) {
+  release();
+
+  if (len <= LOCAL_CAPACITY)
+    return setLocal(len);
+
+  StringArena* arena = StringArena::current();
+  if (arena) {
+    char* p = arena->allocate(len + 1);
+    p[len] = 0;
+    setArena(p, len);
+    return p;
+  }
+
+  setShared(StringRef::create(len));
+  return rep.shared.ref->data;
+}
+
+/**
+ * Complete the release of a biased reference by its owner once the
+ * owner's own count has dropped to zero.  From then on the reference is
+ * counted only in its shared count.  Returns true if no references
+ * remain (the caller should free it).
+ */
+bool String::releaseBiased(StringRef* ref) {
+  // only the owner sets BIAS_MERGED, so adding it sets the flag
+  int countWas = ref->refCount.fetchAdd(StringRef::BIAS_MERGED,
+                                        MEMORY_ACQ_REL);
+
+  // a queued reference is left for the owner to free when it merges it
+  return countWas == 0;
+}
+
+/**
+ * Release a biased reference from a thread other than its owner (or
+ * after it has been merged).  A release that drives the shared count
+ * negative is releasing a reference counted by the owner, so the
+ * reference is handed to the owner to merge the two counts.  Returns
+ * true if no references remain (the caller should free it).
+ */
+bool String::releaseShared(StringRef* ref) {
+  int countWas = ref->refCount.load(MEMORY_RELAXED);
+  int count;
+  bool queue;
+
+  do {
+    count = countWas - StringRef::BIAS_UNIT;
+    queue = !(countWas & (StringRef::BIAS_MERGED | StringRef::BIAS_QUEUED)) &&
+            count < 0;
+    if (queue)
+      count |= StringRef::BIAS_QUEUED;
+  } while (!ref->refCount.compareExchange(countWas, count, MEMORY_ACQ_REL));
+
+  if (queue) {
+    OwnerRecord* owner = static_cast<OwnerRecord*>(ref->owner);
+    std::lock_guard<std::mutex> guard(owner->lock);
+
+    if (owner->active) {
+      owner->queue.push_back(ref);
+      owner->pending.store(true, MEMORY_RELAXED);
+    } else {
+      // no thread is counting in biasedCount, so it is safe to merge
+      mergeReference(ref);
+    }
+    return false;
+  }
+
+  // once merged, the last release leaves only the flag
+  return count == StringRef::BIAS_MERGED;
+}
+
+/**
+ * Merge the references handed back to the current thread by other
+ * threads.
+ */
+void String::mergeQueued() {
+  OwnerRecord* owner = static_cast<OwnerRecord*>(StringRef::currentOwner);
+  std::vector<StringRef*> queued;
+
+  {
+    std::lock_guard<std::mutex> guard(owner->lock);
+    queued.swap(owner->queue);
+    owner->pending.store(false, MEMORY_RELAXED);
+  }
+
+  for (size_t i = 0; i < queued.size(); i++)
+    mergeReference(queued[i]);
 }
 
 /**
- * Release any reference to the current data.
+ * Release any reference to the current data.  This leaves the string
+ * empty.
  */
 void String::release() {
-  if (ref) {
-    if (releaseReference(ref))
-      delete ref;
-    ref = 0;
+  if (!isLocal()) {
+    StringRef* ref = rep.shared.ref;
+    if (ref && releaseReference(ref))
+      StringRef::destroy(ref);
+    setLocal((size_t)0);
   }
 }
@@ -0,0 +1,435 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+/**
+ * StringAllocator
+ *
+ * Memory allocation for the data of Strings.
+ */
+#include <mcl/StringAllocator.h>
+
+#include <mcl/config.h>
+#include <mcl/Atomic.h>
+#include <mcl/OutOfBoundsException.h>
+#include <mcl/OutOfMemoryException.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef WIN32
+#include <malloc.h>
+#endif
+
+#include <mutex>
+
+using namespace mcl;
+
+namespace {
+
+/**
+ * The state of one size class within a Heap.
+ */
+struct SizeClass {
+  /** Blocks freed by the owner, linked through their first word */
+  void* freeList;
+  /** Blocks freed by other threads, linked the same way */
+  Atomic<void*> remoteList;
+  /** The unused part of the newest slab */
+  char* next;
+  char* end;
+  /**
+   * Statistics.  Only the owner updates them (with plain loads and
+   * stores, rather than read-modify-write operations), but any thread
+   * may read them.
+   */
+  Atomic<size_t> allocations;
+  Atomic<size_t> frees;
+  Atomic<size_t> slabs;
+};
+
+/**
+ * The slabs and free lists used by one thread.  Heaps are never freed:
+ * when a thread exits its heap becomes inactive and is later reused by
+ * another thread, which takes over the blocks the heap holds.
+ */
+struct Heap {
+  SizeClass classes[SlabAllocator::SIZE_CLASSES];
+  /** Statistics for blocks too large for a size class */
+  Atomic<size_t> largeAllocations;
+  Atomic<size_t> largeFrees;
+  Atomic<size_t> largeBytesAllocated;
+  Atomic<size_t> largeBytesFreed;
+  /** Set while a thread is using this heap (guarded by heapsLock) */
+  bool active;
+  /** The next inactive heap (guarded by heapsLock) */
+  Heap* nextFree;
+  /** The next heap of all of those created */
+  Heap* nextHeap;
+};
+
+/**
+ * The header at the beginning of every slab, which is aligned to
+ * SLAB_SIZE so that the header of any block may be found by masking
+ * its address.
+ */
+struct Slab {
+  Heap* heap;
+  int sizeClass;
+};
+
+/** The space reserved for the header at the beginning of a slab */
+const size_t SLAB_HEADER = 64;
+
+/** Guards the lists of heaps */
+std::mutex heapsLock;
+/** Every heap created */
+Heap* allHeaps = 0;
+/** Inactive heaps available for reuse */
+Heap* freeHeaps = 0;
+
+/** The heap of the current thread, or 0 */
+_MCL_THREAD_LOCAL Heap* currentHeap = 0;
+/** Set once the current thread has released its heap on exit */
+_MCL_THREAD_LOCAL bool heapReleased = false;
+
+/**
+ * Releases the heap of the current thread when the thread exits.
+ */
+struct HeapExit {
+  bool armed;
+  ~HeapExit();
+};
+
+thread_local HeapExit heapExit;
+
+/**
+ * Return the heap of the current thread, taking over an inactive heap
+ * or creating a new one if the thread does not have one yet.
+ */
+Heap* localHeap() {
+  Heap* heap = currentHeap;
+  if (heap)
+    return heap;
+
+  {
+    std::lock_guard<std::mutex> guard(heapsLock);
+    heap = freeHeaps;
+    if (heap) {
+      freeHeaps = heap->nextFree;
+    } else {
+      heap = new Heap;
+      if (!heap)
+        throw OutOfMemoryException();
+
+      for (int i = 0; i < SlabAllocator::SIZE_CLASSES; i++) {
+        heap->classes[i].freeList = 0;
+        heap->classes[i].next = 0;
+        heap->classes[i].end = 0;
+      }
+      heap->nextHeap = allHeaps;
+      allHeaps = heap;
+    }
+    heap->active = true;
+  }
+
+  currentHeap = heap;
+  // once the thread's heap has been released at exit (by the
+  // destructor of heapExit), any heap needed by later destructors is
+  // kept by the thread for good
+  if (!heapReleased)
+    heapExit.armed = true;
+
+  return heap;
+}
+
+HeapExit::~HeapExit() {
+  if (!armed)
+    return;
+
+  std::lock_guard<std::mutex> guard(heapsLock);
+  Heap* heap = currentHeap;
+  heap->active = false;
+  heap->nextFree = freeHeaps;
+  freeHeaps = heap;
+
+  currentHeap = 0;
+  heapReleased = true;
+}
+
+/**
+ * Add n to a statistic updated by a single thread.
+ */
+inline void count(Atomic<size_t>& stat, size_t n = 1) {
+  stat.store(stat.load(MEMORY_RELAXED) + n, MEMORY_RELAXED);
+}
+
+/**
+ * Allocate a slab aligned to its size, or return 0.
+ */
+void* allocateSlab() {
+#ifdef WIN32
+  return _aligned_malloc(SlabAllocator::SLAB_SIZE, SlabAllocator::SLAB_SIZE);
+#else
+  void* slab = 0;
+  if (posix_memalign(&slab, SlabAllocator::SLAB_SIZE,
+                     SlabAllocator::SLAB_SIZE) != 0)
+    return 0;
+  return slab;
+#endif
+}
+
+/**
+ * Return the slab holding block.
+ */
+inline Slab* slabOf(void* block) {
+  return reinterpret_cast<Slab*>((uintptr_t)block &
+                                 ~(uintptr_t)(SlabAllocator::SLAB_SIZE - 1));
+}
+
+/**
+ * Return the link to the next block stored in the first word of a free
+ * block.
+ */
+inline void*& nextBlock(void* block) {
+  return *static_cast<void**>(block);
+}
+
+} // namespace
+
+
+/**
+ * Change the size of a block by allocating a new one, copying the
+ * contents and freeing the old one.  See the declaration for details.
+ */
+void* StringAllocator::reallocate(void* block, size_t size, size_t newSize) {
+  void* result = allocate(newSize);
+  if (!result)
+    return 0;
+
+  memcpy(result, block, size < newSize ? size : newSize);
+  deallocate(block, size);
+
+  return result;
+}
+
+/**
+ * Use allocator for the StringRefs created from now on (0 restores the
+ * default, SlabAllocator).  StringRefs that already exist are still
+ * freed by the allocator they came from, which therefore must not be
+ * destroyed while they remain.
+ *
+ * @param allocator The allocator to use.
+ */
+void StringAllocator::use(StringAllocator* allocator) {
+  active = allocator ? allocator : &SlabAllocator::defaultInstance;
+}
+
+StringAllocator* StringAllocator::active = &SlabAllocator::defaultInstance;
+
+
+/**
+ * Allocate a block with malloc().
+ */
+void* MallocAllocator::allocate(size_t size) {
+  return malloc(size);
+}
+
+/**
+ * Resize a block with realloc().
+ */
+void* MallocAllocator::reallocate(void* block, size_t, size_t newSize) {
+  return realloc(block, newSize);
+}
+
+/**
+ * Free a block with free().
+ */
+void MallocAllocator::deallocate(void* block, size_t) {
+  free(block);
+}
+
+/**
+ * Return the shared MallocAllocator.
+ */
+MallocAllocator& MallocAllocator::instance() {
+  static MallocAllocator allocator;
+  return allocator;
+}
+
+
+SlabAllocator SlabAllocator::defaultInstance;
+
+/**
+ * Allocate a block of size bytes from the current thread's slabs, or
+ * with malloc() if it is larger than MAX_BLOCK.
+ */
+void* SlabAllocator::allocate(size_t size) {
+  Heap* heap = localHeap();
+
+  if (size > MAX_BLOCK) {
+    void* block = malloc(size);
+    if (block) {
+      count(heap->largeAllocations);
+      count(heap->largeBytesAllocated, size);
+    }
+    return block;
+  }
+
+  int c = sizeClass(size);
+  SizeClass& sc = heap->classes[c];
+
+  // reuse a freed block, first of those freed by this thread
+  void* block = sc.freeList;
+  if (!block && sc.remoteList.load(MEMORY_RELAXED))
+    block = sc.remoteList.exchange(0, MEMORY_ACQUIRE);
+  if (block) {
+    sc.freeList = nextBlock(block);
+    count(sc.allocations);
+    return block;
+  }
+
+  size_t bytes = blockSize(c);
+  if (!sc.next || (size_t)(sc.end - sc.next) < bytes) {
+    char* slab = static_cast<char*>(allocateSlab());
+    if (!slab)
+      return 0;
+
+    Slab* header = reinterpret_cast<Slab*>(slab);
+    header->heap = heap;
+    header->sizeClass = c;
+    count(sc.slabs);
+
+    sc.next = slab + SLAB_HEADER;
+    sc.end = slab + SLAB_SIZE;
+  }
+
+  block = sc.next;
+  sc.next += bytes;
+  count(sc.allocations);
+  return block;
+}
+
+/**
+ * Resize a block.  A block that stays within its size class is left
+ * where it is, and one that remains too large for any size class is
+ * resized with realloc().
+ */
+void* SlabAllocator::reallocate(void* block, size_t size, size_t newSize) {
+  if (size > MAX_BLOCK && newSize > MAX_BLOCK) {
+    void* result = realloc(block, newSize);
+    if (result) {
+      Heap* heap = localHeap();
+      count(heap->largeAllocations);
+      count(heap->largeBytesAllocated, newSize);
+      count(heap->largeFrees);
+      count(heap->largeBytesFreed, size);
+    }
+    return result;
+  }
+
+  if (size <= MAX_BLOCK && newSize <= MAX_BLOCK &&
+      sizeClass(size) == sizeClass(newSize))
+    return block;
+
+  return StringAllocator::reallocate(block, size, newSize);
+}
+
+/**
+ * Free a block, returning it to the free list of the thread that
+ * allocated it.
+ */
+void SlabAllocator::deallocate(void* block, size_t size) {
+  Heap* heap = localHeap();
+
+  if (size > MAX_BLOCK) {
+    count(heap->largeFrees);
+    count(heap->largeBytesFreed, size);
+    free(block);
+    return;
+  }
+
+  Slab* slab = slabOf(block);
+  count(heap->classes[slab->sizeClass].frees);
+
+  SizeClass& sc = slab->heap->classes[slab->sizeClass];
+  if (slab->heap == heap) {
+    nextBlock(block) = sc.freeList;
+    sc.freeList = block;
+    return;
+  }
+
+  // push the block onto the owner's list of remote frees
+  void* head = sc.remoteList.load(MEMORY_RELAXED);
+  do {
+    nextBlock(block) = head;
+  } while (!sc.remoteList.compareExchange(head, block, MEMORY_RELEASE));
+}
+
+/**
+ * Return the size of the blocks in a size class (0 to SIZE_CLASSES - 1).
+ * The classes are spaced 32 bytes apart up to 256 bytes, 64 bytes apart
+ * up to 512 and 128 bytes apart up to MAX_BLOCK.
+ */
+size_t SlabAllocator::blockSize(int sizeClass) {
+  if (sizeClass < 0 || sizeClass >= SIZE_CLASSES)
+    throw OutOfBoundsException(0, SIZE_CLASSES - 1, (size_t)sizeClass);
+
+  if (sizeClass < 8)
+    return (size_t)(sizeClass + 1) * 32;
+  if (sizeClass < 12)
+    return 256 + (size_t)(sizeClass - 7) * 64;
+  return 512 + (size_t)(sizeClass - 11) * 128;
+}
+
+/**
+ * Return the size class blocks of size bytes are allocated from, or
+ * SIZE_CLASSES if they are larger than MAX_BLOCK.
+ */
+int SlabAllocator::sizeClass(size_t size) {
+  if (size <= 256)
+    return size ? (int)((size - 1) / 32) : 0;
+  if (size <= 512)
+    return 8 + (int)((size - 257) / 64);
+  if (size <= MAX_BLOCK)
+    return 12 + (int)((size - 513) / 128);
+  return SIZE_CLASSES;
+}
+
+/**
+ * Return the statistics of a size class (0 to SIZE_CLASSES - 1), or of
+ * the blocks larger than MAX_BLOCK (SIZE_CLASSES), totalled over every
+ * thread.  They are gathered without stopping other threads, so they
+ * may be slightly out of date.
+ *
+ * @param sizeClass The size class.
+ */
+SlabAllocator::Stats SlabAllocator::stats(int sizeClass) const {
+  if (sizeClass < 0 || sizeClass > SIZE_CLASSES)
+    throw OutOfBoundsException(0, SIZE_CLASSES, (size_t)sizeClass);
+
+  Stats result;
+  memset(&result, 0, sizeof(result));
+
+  std::lock_guard<std::mutex> guard(heapsLock);
+  for (Heap* heap = allHeaps; heap; heap = heap->nextHeap) {
+    if (sizeClass == SIZE_CLASSES) {
+      result.allocations += heap->largeAllocations.load(MEMORY_RELAXED);
+      result.frees += heap->largeFrees.load(MEMORY_RELAXED);
+      result.bytesAllocated += heap->largeBytesAllocated.load(MEMORY_RELAXED);
+      result.bytesFreed += heap->largeBytesFreed.load(MEMORY_RELAXED);
+    } else {
+      const SizeClass& sc = heap->classes[sizeClass];
+      result.allocations += sc.allocations.load(MEMORY_RELAXED);
+      result.frees += sc.frees.load(MEMORY_RELAXED);
+      result.bytesReserved += sc.slabs.load(MEMORY_RELAXED) * SLAB_SIZE;
+    }
+  }
+
+  if (sizeClass < SIZE_CLASSES) {
+    result.blockSize = blockSize(sizeClass);
+    result.bytesAllocated = result.allocations * result.blockSize;
+    result.bytesFreed = result.frees * result.blockSize;
+  }
+
+  return result;
+}
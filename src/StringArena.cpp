@@ -0,0 +1,91 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+/**
+ * StringArena
+ *
+ * A region of memory for Strings that are freed together.
+ */
+#include <mcl/StringArena.h>
+
+#include <mcl/OutOfMemoryException.h>
+
+#include <stdlib.h>
+
+using namespace mcl;
+
+namespace {
+
+/** The largest block allocated for ordinary use */
+const size_t MAX_BLOCK = 64 * 1024;
+
+} // namespace
+
+_MCL_THREAD_LOCAL StringArena* StringArena::active = 0;
+
+/**
+ * Construct an arena and make it the one Strings created by the
+ * current thread are allocated from, until it is destroyed.
+ *
+ * @param blockSize The size of the first block of memory to allocate
+ *                  (no memory is allocated until it is needed).
+ */
+StringArena::StringArena(size_t blockSize)
+  : previous(active), blocks(0), start(0), next(0), end(0),
+    blockSize(blockSize ? blockSize : (size_t)DEFAULT_BLOCK), used(0),
+    reserved(0) {
+  active = this;
+}
+
+/**
+ * Destructor.  All of the memory of the arena is freed, and the arena
+ * that was active when this one was created becomes active again.
+ */
+StringArena::~StringArena() {
+  active = previous;
+
+  while (blocks) {
+    Block* b = blocks;
+    blocks = b->next;
+    free(b);
+  }
+}
+
+/**
+ * Allocate size bytes from a new block.  A request that is large
+ * compared to the blocks gets a block of its own, leaving the current
+ * block in use; otherwise a new current block is started, each one
+ * twice the size of the last (up to 64 KB).
+ */
+char* StringArena::allocateBlock(size_t size) {
+  bool own = size > blockSize / 4;
+  size_t bytes = own ? size : blockSize;
+
+  Block* b = static_cast<Block*>(malloc(sizeof(Block) + bytes));
+  if (!b)
+    throw OutOfMemoryException();
+  reserved += bytes;
+
+  char* data = reinterpret_cast<char*>(b + 1);
+
+  if (own && blocks) {
+    // keep the current block at the head of the list
+    b->next = blocks->next;
+    blocks->next = b;
+    used += size;
+    return data;
+  }
+
+  b->next = blocks;
+  blocks = b;
+
+  used += next - start;
+  start = data;
+  next = data + size;
+  end = data + bytes;
+
+  if (!own && blockSize < MAX_BLOCK)
+    blockSize *= 2;
+
+  return data;
+}
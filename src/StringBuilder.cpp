@@ -0,0 +1,191 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+/**
+ * StringBuilder
+ *
+ * Builds a String from a sequence of appended values.
+ */
+#include <mcl/StringBuilder.h>
+
+#include <mcl/IntegerWrapException.h>
+#include <mcl/number_functions.h>
+
+#include <string.h>
+
+using namespace mcl;
+
+
+/**
+ * Construct an empty StringBuilder.
+ */
+StringBuilder::StringBuilder()
+  : buf(local), len(0), cap(INLINE_CAPACITY), ref(0) { }
+
+/**
+ * Construct an empty StringBuilder with room for at least capacity
+ * bytes.
+ *
+ * @param capacity The number of bytes to make room for.
+ */
+StringBuilder::StringBuilder(size_t capacity)
+  : buf(local), len(0), cap(INLINE_CAPACITY), ref(0) {
+  reserve(capacity);
+}
+
+/**
+ * Destructor
+ */
+StringBuilder::~StringBuilder() {
+  if (ref)
+    StringRef::destroy(ref);
+}
+
+/**
+ * Append the null-terminated string str.
+ *
+ * @param str The string to append.
+ */
+StringBuilder& StringBuilder::append(const char* str) {
+  return append(str, strlen(str));
+}
+
+/**
+ * Append the character c repeat times.
+ *
+ * @param c      The character to append.
+ * @param repeat The number of times to append it.
+ */
+StringBuilder& StringBuilder::append(char c, size_t repeat) {
+  if (cap - len < repeat)
+    grow(repeat);
+
+  memset(buf + len, c, repeat);
+  len += repeat;
+  return *this;
+}
+
+/**
+ * Append the decimal representation of value.
+ *
+ * @param value The number to append.
+ */
+StringBuilder& StringBuilder::append(long long value) {
+  if (cap - len < NUMBER_BUFFER_SIZE)
+    grow(NUMBER_BUFFER_SIZE);
+
+  len += format_int(buf + len, value);
+  return *this;
+}
+
+/**
+ * Append the decimal representation of value.
+ *
+ * @param value The number to append.
+ */
+StringBuilder& StringBuilder::append(unsigned long long value) {
+  if (cap - len < NUMBER_BUFFER_SIZE)
+    grow(NUMBER_BUFFER_SIZE);
+
+  len += format_uint(buf + len, value);
+  return *this;
+}
+
+/**
+ * Append the shortest decimal representation of value that converts
+ * back to the same value (see String::fromDouble()).
+ *
+ * @param value The number to append.
+ */
+StringBuilder& StringBuilder::append(double value) {
+  if (cap - len < NUMBER_BUFFER_SIZE)
+    grow(NUMBER_BUFFER_SIZE);
+
+  len += format_double(buf + len, value);
+  return *this;
+}
+
+/**
+ * Make sure there is room for at least capacity bytes in total without
+ * allocating more memory.
+ *
+ * @param capacity The number of bytes to make room for.
+ */
+void StringBuilder::reserve(size_t capacity) {
+  if (capacity > cap)
+    grow(capacity - len);
+}
+
+/**
+ * Return a String holding the data appended so far, and leave this
+ * StringBuilder empty.  If the data has outgrown the space inside the
+ * StringBuilder, the String takes over the memory holding it rather
+ * than copying it.
+ */
+String StringBuilder::toString() {
+  String result;
+
+  if (!ref || len <= String::LOCAL_CAPACITY) {
+    result.assign(buf, len);
+  } else {
+    // give the String the data, returning unused memory if it is a lot
+    StringRef* done = ref;
+    if (cap - len > len / 2) {
+      done = StringRef::resize(done, len);
+    } else {
+      done->size = len;
+      done->data[len] = 0;
+    }
+
+    ref = 0;
+    buf = local;
+    cap = INLINE_CAPACITY;
+    result.setShared(done);
+  }
+
+  len = 0;
+  return result;
+}
+
+/**
+ * Append the count bytes at str when there is not enough room for
+ * them.  The data may be part of this StringBuilder's own.
+ */
+StringBuilder& StringBuilder::appendGrowing(const char* str, size_t count) {
+  bool own = (str >= buf && str < buf + len);
+
+  if (own) {
+    size_t offset = str - buf;
+    grow(count);
+    str = buf + offset;
+  } else {
+    grow(count);
+  }
+
+  memcpy(buf + len, str, count);
+  len += count;
+  return *this;
+}
+
+/**
+ * Make room for at least needed more bytes, at least doubling the
+ * capacity.
+ */
+void StringBuilder::grow(size_t needed) {
+  if (needed > (size_t)-1 - sizeof(StringRef) - 1 - len)
+    throw IntegerWrapException();
+
+  size_t newCap = cap * 2;
+  if (newCap < len + needed)
+    newCap = len + needed;
+
+  if (ref) {
+    ref = StringRef::resize(ref, newCap);
+  } else {
+    ref = StringRef::create(newCap);
+    memcpy(ref->data, buf, len);
+  }
+
+  buf = ref->data;
+  cap = newCap;
+}
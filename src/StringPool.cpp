@@ -0,0 +1,206 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+/**
+ * StringPool
+ *
+ * A table of interned (canonical) strings.
+ */
+#include <mcl/StringPool.h>
+
+#include <mcl/Atomic.h>
+#include <mcl/OutOfMemoryException.h>
+
+using namespace mcl;
+
+namespace mcl {
+  // the identifier of the most recently created pool
+  static Atomic<int> lastPoolId(0);
+}
+
+
+/**
+ * Construct an empty pool.
+ *
+ * @param capacity The initial number of hash buckets.
+ */
+StringPool::StringPool(size_t capacity)
+  : id(0), buckets(0), capacity(0), count(0) {
+  // every pool gets an identifier that is never reused
+  id = lastPoolId.fetchAdd(1, MEMORY_RELAXED) + 1;
+
+  rehash(capacity < 1 ? 1 : capacity);
+}
+
+/**
+ * Destructor.  Strings previously returned by intern() are unaffected.
+ */
+StringPool::~StringPool() {
+  for (size_t i = 0; i < capacity; i++) {
+    Entry* e = buckets[i];
+    while (e) {
+      Entry* next = e->next;
+      delete e;
+      e = next;
+    }
+  }
+
+  delete [] buckets;
+}
+
+/**
+ * Return the canonical String with the same contents as str.  The
+ * first time a value is interned, a copy of it is added to the pool.
+ *
+ * @param str The string to intern.
+ *
+ * @return The interned string.
+ */
+String StringPool::intern(const String& str) {
+  size_t h = String::hash(str);
+  size_t len = str.size();
+
+  std::lock_guard<std::mutex> guard(lock);
+
+  // look for an existing entry
+  for (Entry* e = buckets[h % capacity]; e; e = e->next) {
+    if (e->hash == h && e->str.size() == len &&
+        memcmp(e->str.data(), str.data(), len) == 0)
+      return e->str;
+  }
+
+  // make room, preferring to reuse the space of unused entries; unless
+  // that frees at least half of the table it grows as well, so that
+  // there is one scan of the table at most per capacity / 2 insertions
+  if (count >= capacity) {
+    evictUnused();
+    if (count >= capacity / 2)
+      rehash(capacity * 2);
+  }
+
+  // add a new entry
+  // entries are shared by every thread, so they are never biased
+  StringRef* ref = StringRef::create(len, false);
+  memcpy(ref->data, str.data(), len);
+  ref->pool = id;
+  ref->hashCode.store(h, MEMORY_RELAXED);
+
+  Entry* e = new Entry;
+  if (!e) {
+    StringRef::destroy(ref);
+    throw OutOfMemoryException();
+  }
+
+  e->str.release();
+  e->str.setShared(ref);
+  e->hash = h;
+
+  Entry*& bucket = buckets[h % capacity];
+  e->next = bucket;
+  bucket = e;
+  count++;
+
+  return e->str;
+}
+
+/**
+ * Remove every entry that is no longer referenced outside of the pool.
+ *
+ * @return The number of entries removed.
+ */
+size_t StringPool::evict() {
+  std::lock_guard<std::mutex> guard(lock);
+  return evictUnused();
+}
+
+/**
+ * Return the number of strings in the pool.
+ */
+size_t StringPool::size() const {
+  std::lock_guard<std::mutex> guard(lock);
+  return count;
+}
+
+/**
+ * Return the number of buckets in the hash table.
+ */
+size_t StringPool::bucketCount() const {
+  std::lock_guard<std::mutex> guard(lock);
+  return capacity;
+}
+
+/**
+ * Return an estimate of the memory saved by the pool: for each entry,
+ * the size of the copies that every reference to it beyond the first
+ * would otherwise have needed.
+ */
+size_t StringPool::bytesSaved() const {
+  std::lock_guard<std::mutex> guard(lock);
+
+  size_t saved = 0;
+  for (size_t i = 0; i < capacity; i++) {
+    for (Entry* e = buckets[i]; e; e = e->next) {
+      StringRef* ref = e->str.rep.shared.ref;
+      int holders = ref->refCount.load(MEMORY_RELAXED) - 1;
+      if (holders > 1)
+        saved += (holders - 1) * (sizeof(StringRef) + ref->size + 1);
+    }
+  }
+
+  return saved;
+}
+
+/**
+ * Resize the hash table.  The caller must hold the lock.
+ */
+void StringPool::rehash(size_t newCapacity) {
+  if (newCapacity <= capacity && buckets)
+    return;
+
+  Entry** newBuckets = new Entry*[newCapacity];
+  if (!newBuckets)
+    throw OutOfMemoryException();
+  memset(newBuckets, 0, newCapacity * sizeof(Entry*));
+
+  // move entries to their new buckets
+  for (size_t i = 0; i < capacity; i++) {
+    Entry* e = buckets[i];
+    while (e) {
+      Entry* next = e->next;
+      Entry*& bucket = newBuckets[e->hash % newCapacity];
+      e->next = bucket;
+      bucket = e;
+      e = next;
+    }
+  }
+
+  delete [] buckets;
+  buckets = newBuckets;
+  capacity = newCapacity;
+}
+
+/**
+ * Remove unused entries.  The caller must hold the lock.  (An entry
+ * whose only reference is the pool's cannot gain new references except
+ * through intern(), so the check is safe while the lock is held.)
+ */
+size_t StringPool::evictUnused() {
+  size_t removed = 0;
+
+  for (size_t i = 0; i < capacity; i++) {
+    Entry** link = &buckets[i];
+    while (*link) {
+      Entry* e = *link;
+      if (e->str.rep.shared.ref->refCount.load(MEMORY_ACQUIRE) <= 1) {
+        *link = e->next;
+        delete e;
+        removed++;
+      } else {
+        link = &e->next;
+      }
+    }
+  }
+
+  count -= removed;
+  return removed;
+}
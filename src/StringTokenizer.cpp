@@ -0,0 +1,88 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+/**
+ * StringTokenizer
+ *
+ * Produces the fields of a delimited String one at a time.
+ */
+#include <mcl/StringTokenizer.h>
+
+#include <mcl/memory_functions.h>
+#include <mcl/OutOfBoundsException.h>
+
+using namespace mcl;
+
+
+/**
+ * Construct a tokenizer for the fields of str separated by the
+ * character delim.
+ *
+ * @param str   The string to tokenize.
+ * @param delim The character separating fields.
+ */
+StringTokenizer::StringTokenizer(const String& str, char delim)
+  : str(str), delim(delim), pos(0), fields(0), done(false) { }
+
+/**
+ * Construct a tokenizer for the fields of str separated by the string
+ * delim.  If delim is empty, str is a single field.
+ *
+ * @param str   The string to tokenize.
+ * @param delim The string separating fields.
+ */
+StringTokenizer::StringTokenizer(const String& str, const String& delim)
+  : str(str), delim(delim), pos(0), fields(0), done(false) { }
+
+/**
+ * Assign the next field to field and return true, or return false
+ * (leaving field unchanged) if every field has already been returned.
+ *
+ * @param field The string to assign the field to.
+ */
+bool StringTokenizer::next(String& field) {
+  if (done)
+    return false;
+
+  const char* d = str.data();
+  size_t len = str.size();
+  size_t delimLen = delim.size();
+  const char* found = 0;
+
+  if (delimLen == 1)
+    found = (const char*)mem_find_char(d + pos, len - pos, delim.data()[0]);
+  else if (delimLen > 1)
+    found = (const char*)mem_find(d + pos, len - pos, delim.data(), delimLen);
+
+  size_t stop = found ? (size_t)(found - d) : len;
+  field.assignSlice(str, pos, stop - pos, false);
+  fields++;
+
+  if (found)
+    pos = stop + delimLen;
+  else
+    done = true;
+
+  return true;
+}
+
+/**
+ * Return the next field.  An OutOfBoundsException is thrown if every
+ * field has already been returned (see hasNext()).
+ */
+String StringTokenizer::next() {
+  String field;
+  if (!next(field))
+    throw OutOfBoundsException(0, fields - 1, fields);
+
+  return field;
+}
+
+/**
+ * Start over with the first field.
+ */
+void StringTokenizer::reset() {
+  pos = 0;
+  fields = 0;
+  done = false;
+}
@@ -12,6 +12,9 @@ namespace mcl {
     "Invalid reference count",
     "Out of memory",
     "Index out of bounds",
+    "Input/output error",
+    "Invalid number format",
+    "Invalid format string or arguments",
     0
   };
   
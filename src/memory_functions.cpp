@@ -0,0 +1,584 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+/**
+ * Functions operating on blocks of memory of a known size
+ */
+
+#include <mcl/memory_functions.h>
+#include <mcl/config.h>
+#include <mcl/Atomic.h>
+
+#include <string.h>
+
+#ifdef _MCL_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace mcl {
+
+typedef const unsigned char* bytes;
+
+/**
+ * Levels of vector instruction support
+ */
+enum { SIMD_UNKNOWN = -1, SIMD_NONE = 0, SIMD_SSE2, SIMD_AVX2 };
+
+/**
+ * The detected level, or SIMD_UNKNOWN.  Threads that detect it at the
+ * same time store the same value, so relaxed ordering is enough.
+ */
+static Atomic<int> detectedLevel(SIMD_UNKNOWN);
+
+/**
+ * Return the best level of vector instructions this processor
+ * supports.  This is determined the first time it is needed.
+ */
+static inline int simdLevel() {
+  int level = detectedLevel.load(MEMORY_RELAXED);
+  if (level != SIMD_UNKNOWN)
+    return level;
+
+  level = SIMD_NONE;
+#ifdef _MCL_X86_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    level = SIMD_AVX2;
+  else if (__builtin_cpu_supports("sse2"))
+    level = SIMD_SSE2;
+#endif
+
+  detectedLevel.store(level, MEMORY_RELAXED);
+  return level;
+}
+
+
+/*
+ * Portable implementations
+ */
+
+/**
+ * Find the last occurrence of c in the len bytes at data.
+ */
+static bytes rfindCharGeneric(bytes data, size_t len, unsigned char c) {
+  while (len) {
+    if (data[--len] == c)
+      return data + len;
+  }
+
+  return 0;
+}
+
+/**
+ * Count the occurrences of c in the len bytes at data.
+ */
+static size_t countCharGeneric(bytes data, size_t len, unsigned char c) {
+  size_t total = 0;
+  for (size_t i = 0; i < len; i++)
+    total += (data[i] == c);
+
+  return total;
+}
+
+/**
+ * Find needle (of nlen > 1 bytes) in haystack by searching for its
+ * first byte and then comparing the rest.
+ */
+static bytes findGeneric(bytes haystack, size_t hlen,
+                         bytes needle, size_t nlen) {
+  bytes end = haystack + hlen - nlen + 1;
+
+  while (haystack < end) {
+    bytes p = (bytes)memchr(haystack, needle[0], end - haystack);
+    if (!p)
+      return 0;
+    if (memcmp(p + 1, needle + 1, nlen - 1) == 0)
+      return p;
+    haystack = p + 1;
+  }
+
+  return 0;
+}
+
+
+#ifdef _MCL_X86_SIMD
+
+/*
+ * SSE2 and AVX2 implementations
+ *
+ * Blocks are compared a vector at a time, and the positions of
+ * matching bytes are extracted from the comparison mask.
+ */
+
+/**
+ * Return the difference of the first unequal bytes of a and b within
+ * a block, given the mask of unequal positions (which is non-zero).
+ */
+static inline int maskDifference(bytes a, bytes b, unsigned mask) {
+  size_t pos = __builtin_ctz(mask);
+  return (int)a[pos] - (int)b[pos];
+}
+
+/**
+ * SSE2 mem_compare: compares 16 bytes at a time.  The final partial
+ * block is handled by comparing the last 16 bytes, overlapping bytes
+ * already known to be equal.
+ */
+__attribute__((target("sse2")))
+static int compareSSE2(bytes a, bytes b, size_t len) {
+  if (len < 16)
+    return memcmp(a, b, len);
+
+  size_t i = 0;
+  for (;;) {
+    __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+    __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+    unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) ^ 0xffff;
+    if (mask)
+      return maskDifference(a + i, b + i, mask);
+
+    if (i + 16 == len)
+      return 0;
+
+    i += 16;
+    if (i + 16 > len)
+      i = len - 16;
+  }
+}
+
+/**
+ * AVX2 mem_compare: after the first 32 bytes, compares 64 bytes at a
+ * time (as two 32-byte blocks) from an aligned position in a, then the
+ * remainder in 32-byte blocks, the last of which overlaps bytes already
+ * compared.
+ */
+__attribute__((target("avx2")))
+static int compareAVX2(bytes a, bytes b, size_t len) {
+  if (len < 32)
+    return compareSSE2(a, b, len);
+
+  // compare the first block, then continue from where a is aligned
+  __m256i x = _mm256_loadu_si256((const __m256i*)a);
+  __m256i y = _mm256_loadu_si256((const __m256i*)b);
+  unsigned mask = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y));
+  if (mask)
+    return maskDifference(a, b, mask);
+
+  size_t i = 32 - ((size_t)a & 31);
+  for (; i + 64 <= len; i += 64) {
+    __m256i x0 = _mm256_load_si256((const __m256i*)(a + i));
+    __m256i y0 = _mm256_loadu_si256((const __m256i*)(b + i));
+    __m256i x1 = _mm256_load_si256((const __m256i*)(a + i + 32));
+    __m256i y1 = _mm256_loadu_si256((const __m256i*)(b + i + 32));
+    __m256i eq0 = _mm256_cmpeq_epi8(x0, y0);
+    __m256i eq1 = _mm256_cmpeq_epi8(x1, y1);
+
+    if (~(unsigned)_mm256_movemask_epi8(_mm256_and_si256(eq0, eq1))) {
+      mask = ~(unsigned)_mm256_movemask_epi8(eq0);
+      if (mask)
+        return maskDifference(a + i, b + i, mask);
+      mask = ~(unsigned)_mm256_movemask_epi8(eq1);
+      return maskDifference(a + i + 32, b + i + 32, mask);
+    }
+  }
+
+  while (i < len) {
+    if (i + 32 > len)
+      i = len - 32;
+
+    x = _mm256_loadu_si256((const __m256i*)(a + i));
+    y = _mm256_loadu_si256((const __m256i*)(b + i));
+    mask = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y));
+    if (mask)
+      return maskDifference(a + i, b + i, mask);
+
+    i += 32;
+  }
+
+  return 0;
+}
+
+/**
+ * SSE2 mem_find_char
+ */
+__attribute__((target("sse2")))
+static bytes findCharSSE2(bytes data, size_t len, unsigned char c) {
+  __m128i pattern = _mm_set1_epi8((char)c);
+  size_t i = 0;
+
+  for (; i + 16 <= len; i += 16) {
+    __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+    unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, pattern));
+    if (mask)
+      return data + i + __builtin_ctz(mask);
+  }
+
+  return (bytes)memchr(data + i, c, len - i);
+}
+
+/**
+ * AVX2 mem_find_char: examines 128 bytes per iteration from an aligned
+ * position, only extracting a position once a block is known to
+ * contain c.
+ */
+__attribute__((target("avx2")))
+static bytes findCharAVX2(bytes data, size_t len, unsigned char c) {
+  __m256i pattern = _mm256_set1_epi8((char)c);
+  size_t i = 0;
+
+  // examine the first block, then continue from an aligned position
+  if (len >= 32) {
+    __m256i block = _mm256_loadu_si256((const __m256i*)data);
+    unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, pattern));
+    if (mask)
+      return data + __builtin_ctz(mask);
+    i = 32 - ((size_t)data & 31);
+  }
+
+  for (; i + 128 <= len; i += 128) {
+    __m256i eq0 = _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i*)(data + i)), pattern);
+    __m256i eq1 = _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i*)(data + i + 32)), pattern);
+    __m256i eq2 = _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i*)(data + i + 64)), pattern);
+    __m256i eq3 = _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i*)(data + i + 96)), pattern);
+    __m256i any = _mm256_or_si256(_mm256_or_si256(eq0, eq1), _mm256_or_si256(eq2, eq3));
+    if (!_mm256_testz_si256(any, any))
+      break;
+  }
+
+  for (; i + 32 <= len; i += 32) {
+    __m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+    unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, pattern));
+    if (mask)
+      return data + i + __builtin_ctz(mask);
+  }
+
+  return findCharSSE2(data + i, len - i, c);
+}
+
+/**
+ * SSE2 mem_rfind_char (scans backward from the end)
+ */
+__attribute__((target("sse2")))
+static bytes rfindCharSSE2(bytes data, size_t len, unsigned char c) {
+  __m128i pattern = _mm_set1_epi8((char)c);
+
+  while (len >= 16) {
+    len -= 16;
+    __m128i block = _mm_loadu_si128((const __m128i*)(data + len));
+    unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, pattern));
+    if (mask)
+      return data + len + 31 - __builtin_clz(mask);
+  }
+
+  return rfindCharGeneric(data, len, c);
+}
+
+/**
+ * AVX2 mem_rfind_char (scans backward from the end)
+ */
+__attribute__((target("avx2")))
+static bytes rfindCharAVX2(bytes data, size_t len, unsigned char c) {
+  __m256i pattern = _mm256_set1_epi8((char)c);
+
+  while (len >= 32) {
+    len -= 32;
+    __m256i block = _mm256_loadu_si256((const __m256i*)(data + len));
+    unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, pattern));
+    if (mask)
+      return data + len + 31 - __builtin_clz(mask);
+  }
+
+  return rfindCharSSE2(data, len, c);
+}
+
+/**
+ * SSE2 mem_count_char
+ */
+__attribute__((target("sse2")))
+static size_t countCharSSE2(bytes data, size_t len, unsigned char c) {
+  __m128i pattern = _mm_set1_epi8((char)c);
+  size_t total = 0;
+  size_t i = 0;
+
+  for (; i + 16 <= len; i += 16) {
+    __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+    total += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(block, pattern)));
+  }
+
+  return total + countCharGeneric(data + i, len - i, c);
+}
+
+/**
+ * AVX2 mem_count_char
+ */
+__attribute__((target("avx2,popcnt")))
+static size_t countCharAVX2(bytes data, size_t len, unsigned char c) {
+  __m256i pattern = _mm256_set1_epi8((char)c);
+  size_t total = 0;
+  size_t i = 0;
+
+  for (; i + 32 <= len; i += 32) {
+    __m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+    total += __builtin_popcount(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, pattern)));
+  }
+
+  return total + countCharSSE2(data + i, len - i, c);
+}
+
+/**
+ * SSE2 mem_find.  Candidate positions are found by comparing a block
+ * of the haystack against the needle's first byte, and the block
+ * nlen - 1 bytes further on against its last byte; only positions
+ * where both match are compared in full.
+ */
+__attribute__((target("sse2")))
+static bytes findSSE2(bytes haystack, size_t hlen, bytes needle, size_t nlen) {
+  __m128i first = _mm_set1_epi8((char)needle[0]);
+  __m128i last  = _mm_set1_epi8((char)needle[nlen - 1]);
+  size_t i = 0;
+
+  for (; i + nlen - 1 + 16 <= hlen; i += 16) {
+    __m128i blockFirst = _mm_loadu_si128((const __m128i*)(haystack + i));
+    __m128i blockLast  = _mm_loadu_si128((const __m128i*)(haystack + i + nlen - 1));
+    unsigned mask = _mm_movemask_epi8(_mm_and_si128(
+        _mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last)));
+
+    while (mask) {
+      size_t pos = i + __builtin_ctz(mask);
+      if (memcmp(haystack + pos + 1, needle + 1, nlen - 2) == 0)
+        return haystack + pos;
+      mask &= mask - 1;
+    }
+  }
+
+  return findGeneric(haystack + i, hlen - i, needle, nlen);
+}
+
+/**
+ * AVX2 mem_find (see findSSE2).  Candidates are located 64 bytes at a
+ * time.
+ */
+__attribute__((target("avx2")))
+static bytes findAVX2(bytes haystack, size_t hlen, bytes needle, size_t nlen) {
+  __m256i first = _mm256_set1_epi8((char)needle[0]);
+  __m256i last  = _mm256_set1_epi8((char)needle[nlen - 1]);
+  size_t i = 0;
+
+  for (; i + nlen - 1 + 64 <= hlen; i += 64) {
+    bytes p = haystack + i;
+    __m256i match0 = _mm256_and_si256(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)p), first),
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(p + nlen - 1)), last));
+    __m256i match1 = _mm256_and_si256(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(p + 32)), first),
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(p + 31 + nlen)), last));
+
+    __m256i any = _mm256_or_si256(match0, match1);
+    if (_mm256_testz_si256(any, any))
+      continue;
+
+    unsigned long long mask = (unsigned)_mm256_movemask_epi8(match0) |
+      ((unsigned long long)(unsigned)_mm256_movemask_epi8(match1) << 32);
+
+    while (mask) {
+      size_t pos = i + __builtin_ctzll(mask);
+      if (memcmp(haystack + pos + 1, needle + 1, nlen - 2) == 0)
+        return haystack + pos;
+      mask &= mask - 1;
+    }
+  }
+
+  return findSSE2(haystack + i, hlen - i, needle, nlen);
+}
+
+#endif // _MCL_X86_SIMD
+
+
+/*
+ * Public functions
+ */
+
+/**
+ * Compare len bytes of a and b, which may contain any values
+ * (including nulls).  Bytes are compared as unsigned values.
+ *
+ * @param a    The first block of memory
+ * @param b    The second block of memory
+ * @param len  The number of bytes to compare
+ *
+ * @return A value less than, equal to, or greater than zero if a is
+ *         less than, equal to, or greater than b, respectively.
+ */
+int mem_compare(const void* a, const void* b, size_t len) {
+  if (a == b || len == 0)
+    return 0;
+
+#ifdef _MCL_X86_SIMD
+  switch (simdLevel()) {
+  case SIMD_AVX2:
+    return compareAVX2((bytes)a, (bytes)b, len);
+  case SIMD_SSE2:
+    return compareSSE2((bytes)a, (bytes)b, len);
+  }
+#endif
+
+  return memcmp(a, b, len);
+}
+
+/**
+ * Return true if the first len bytes of a and b are the same.
+ *
+ * @param a    The first block of memory
+ * @param b    The second block of memory
+ * @param len  The number of bytes to compare
+ */
+bool mem_equal(const void* a, const void* b, size_t len) {
+  // short blocks aren't worth dispatching
+  if (len < 16)
+    return a == b || memcmp(a, b, len) == 0;
+
+  return mem_compare(a, b, len) == 0;
+}
+
+/**
+ * Find the first occurrence of the byte c in a block of memory.
+ *
+ * @param data The block of memory to search
+ * @param len  The size of the block
+ * @param c    The byte to find
+ *
+ * @return The address of the byte, or 0 if it is not found.
+ */
+const void* mem_find_char(const void* data, size_t len, char c) {
+#ifdef _MCL_X86_SIMD
+  switch (simdLevel()) {
+  case SIMD_AVX2:
+    return findCharAVX2((bytes)data, len, (unsigned char)c);
+  case SIMD_SSE2:
+    return findCharSSE2((bytes)data, len, (unsigned char)c);
+  }
+#endif
+
+  return memchr(data, c, len);
+}
+
+/**
+ * Find the last occurrence of the byte c in a block of memory.
+ *
+ * @param data The block of memory to search
+ * @param len  The size of the block
+ * @param c    The byte to find
+ *
+ * @return The address of the byte, or 0 if it is not found.
+ */
+const void* mem_rfind_char(const void* data, size_t len, char c) {
+#ifdef _MCL_X86_SIMD
+  switch (simdLevel()) {
+  case SIMD_AVX2:
+    return rfindCharAVX2((bytes)data, len, (unsigned char)c);
+  case SIMD_SSE2:
+    return rfindCharSSE2((bytes)data, len, (unsigned char)c);
+  }
+#endif
+
+  return rfindCharGeneric((bytes)data, len, (unsigned char)c);
+}
+
+/**
+ * Count the occurrences of the byte c in a block of memory.
+ *
+ * @param data The block of memory to search
+ * @param len  The size of the block
+ * @param c    The byte to count
+ *
+ * @return The number of times c occurs.
+ */
+size_t mem_count_char(const void* data, size_t len, char c) {
+#ifdef _MCL_X86_SIMD
+  switch (simdLevel()) {
+  case SIMD_AVX2:
+    return countCharAVX2((bytes)data, len, (unsigned char)c);
+  case SIMD_SSE2:
+    return countCharSSE2((bytes)data, len, (unsigned char)c);
+  }
+#endif
+
+  return countCharGeneric((bytes)data, len, (unsigned char)c);
+}
+
+/**
+ * Find the first occurrence of a block of memory (the needle) within
+ * another (the haystack).  An empty needle is found at the start of
+ * the haystack.
+ *
+ * @param haystack The block of memory to search
+ * @param hlen     The size of haystack
+ * @param needle   The block of memory to find
+ * @param nlen     The size of needle
+ *
+ * @return The address of the match within haystack, or 0 if needle is
+ *         not found.
+ */
+const void* mem_find(const void* haystack, size_t hlen,
+                     const void* needle, size_t nlen) {
+  if (nlen == 0)
+    return haystack;
+  if (nlen > hlen)
+    return 0;
+  if (nlen == 1)
+    return mem_find_char(haystack, hlen, *(const char*)needle);
+
+#ifdef _MCL_X86_SIMD
+  switch (simdLevel()) {
+  case SIMD_AVX2:
+    return findAVX2((bytes)haystack, hlen, (bytes)needle, nlen);
+  case SIMD_SSE2:
+    return findSSE2((bytes)haystack, hlen, (bytes)needle, nlen);
+  }
+#endif
+
+  return findGeneric((bytes)haystack, hlen, (bytes)needle, nlen);
+}
+
+/**
+ * Find the last occurrence of a block of memory (the needle) within
+ * another (the haystack).  An empty needle is found at the end of the
+ * haystack.
+ *
+ * @param haystack The block of memory to search
+ * @param hlen     The size of haystack
+ * @param needle   The block of memory to find
+ * @param nlen     The size of needle
+ *
+ * @return The address of the match within haystack, or 0 if needle is
+ *         not found.
+ */
+const void* mem_rfind(const void* haystack, size_t hlen,
+                      const void* needle, size_t nlen) {
+  if (nlen == 0)
+    return (bytes)haystack + hlen;
+  if (nlen > hlen)
+    return 0;
+
+  // search backward for the first byte of the needle, then compare
+  bytes start = (bytes)haystack;
+  size_t len = hlen - nlen + 1;
+  unsigned char first = *(bytes)needle;
+
+  while (len) {
+    bytes p = (bytes)mem_rfind_char(start, len, first);
+    if (!p)
+      return 0;
+    if (memcmp(p + 1, (bytes)needle + 1, nlen - 1) == 0)
+      return p;
+    len = p - start;
+  }
+
+  return 0;
+}
+
+} // namespace
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,581 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+/**
+ * Functions converting numbers to and from their decimal representation
+ */
+
+#include <mcl/number_functions.h>
+#include <mcl/config.h>
+#include <mcl/IntegerWrapException.h>
+#include <mcl/NumberFormatException.h>
+#include <mcl/OutOfMemoryException.h>
+
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace mcl {
+
+/**
+ * The two digits of each number from 0 to 99
+ */
+static const char DIGIT_PAIRS[] =
+  "0001020304050607080910111213141516171819"
+  "2021222324252627282930313233343536373839"
+  "4041424344454647484950515253545556575859"
+  "6061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+/**
+ * The powers of ten that a double represents exactly
+ */
+static const double POWERS_OF_TEN[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+ * The largest integer below which every integer is exactly
+ * representable as a double (2 to the 53rd power)
+ */
+static const double EXACT_INTEGER_LIMIT = 9007199254740992.0;
+
+/**
+ * A floating-point number with a 64-bit significand, f * 2^e, for the
+ * shortest conversion of doubles to decimal
+ */
+struct DiyFp {
+  unsigned long long f;
+  int e;
+};
+
+/**
+ * Normalized approximations of the powers of ten 10^-348, 10^-340 and
+ * so on (every eighth power) up to 10^340
+ */
+static const DiyFp CACHED_POWERS[] = {
+  { 0xfa8fd5a0081c0288ULL, -1220 }, { 0xbaaee17fa23ebf76ULL, -1193 },
+  { 0x8b16fb203055ac76ULL, -1166 }, { 0xcf42894a5dce35eaULL, -1140 },
+  { 0x9a6bb0aa55653b2dULL, -1113 }, { 0xe61acf033d1a45dfULL, -1087 },
+  { 0xab70fe17c79ac6caULL, -1060 }, { 0xff77b1fcbebcdc4fULL, -1034 },
+  { 0xbe5691ef416bd60cULL, -1007 }, { 0x8dd01fad907ffc3cULL, -980 },
+  { 0xd3515c2831559a83ULL, -954 }, { 0x9d71ac8fada6c9b5ULL, -927 },
+  { 0xea9c227723ee8bcbULL, -901 }, { 0xaecc49914078536dULL, -874 },
+  { 0x823c12795db6ce57ULL, -847 }, { 0xc21094364dfb5637ULL, -821 },
+  { 0x9096ea6f3848984fULL, -794 }, { 0xd77485cb25823ac7ULL, -768 },
+  { 0xa086cfcd97bf97f4ULL, -741 }, { 0xef340a98172aace5ULL, -715 },
+  { 0xb23867fb2a35b28eULL, -688 }, { 0x84c8d4dfd2c63f3bULL, -661 },
+  { 0xc5dd44271ad3cdbaULL, -635 }, { 0x936b9fcebb25c996ULL, -608 },
+  { 0xdbac6c247d62a584ULL, -582 }, { 0xa3ab66580d5fdaf6ULL, -555 },
+  { 0xf3e2f893dec3f126ULL, -529 }, { 0xb5b5ada8aaff80b8ULL, -502 },
+  { 0x87625f056c7c4a8bULL, -475 }, { 0xc9bcff6034c13053ULL, -449 },
+  { 0x964e858c91ba2655ULL, -422 }, { 0xdff9772470297ebdULL, -396 },
+  { 0xa6dfbd9fb8e5b88fULL, -369 }, { 0xf8a95fcf88747d94ULL, -343 },
+  { 0xb94470938fa89bcfULL, -316 }, { 0x8a08f0f8bf0f156bULL, -289 },
+  { 0xcdb02555653131b6ULL, -263 }, { 0x993fe2c6d07b7facULL, -236 },
+  { 0xe45c10c42a2b3b06ULL, -210 }, { 0xaa242499697392d3ULL, -183 },
+  { 0xfd87b5f28300ca0eULL, -157 }, { 0xbce5086492111aebULL, -130 },
+  { 0x8cbccc096f5088ccULL, -103 }, { 0xd1b71758e219652cULL, -77 },
+  { 0x9c40000000000000ULL, -50 }, { 0xe8d4a51000000000ULL, -24 },
+  { 0xad78ebc5ac620000ULL, 3 }, { 0x813f3978f8940984ULL, 30 },
+  { 0xc097ce7bc90715b3ULL, 56 }, { 0x8f7e32ce7bea5c70ULL, 83 },
+  { 0xd5d238a4abe98068ULL, 109 }, { 0x9f4f2726179a2245ULL, 136 },
+  { 0xed63a231d4c4fb27ULL, 162 }, { 0xb0de65388cc8ada8ULL, 189 },
+  { 0x83c7088e1aab65dbULL, 216 }, { 0xc45d1df942711d9aULL, 242 },
+  { 0x924d692ca61be758ULL, 269 }, { 0xda01ee641a708deaULL, 295 },
+  { 0xa26da3999aef774aULL, 322 }, { 0xf209787bb47d6b85ULL, 348 },
+  { 0xb454e4a179dd1877ULL, 375 }, { 0x865b86925b9bc5c2ULL, 402 },
+  { 0xc83553c5c8965d3dULL, 428 }, { 0x952ab45cfa97a0b3ULL, 455 },
+  { 0xde469fbd99a05fe3ULL, 481 }, { 0xa59bc234db398c25ULL, 508 },
+  { 0xf6c69a72a3989f5cULL, 534 }, { 0xb7dcbf5354e9beceULL, 561 },
+  { 0x88fcf317f22241e2ULL, 588 }, { 0xcc20ce9bd35c78a5ULL, 614 },
+  { 0x98165af37b2153dfULL, 641 }, { 0xe2a0b5dc971f303aULL, 667 },
+  { 0xa8d9d1535ce3b396ULL, 694 }, { 0xfb9b7cd9a4a7443cULL, 720 },
+  { 0xbb764c4ca7a44410ULL, 747 }, { 0x8bab8eefb6409c1aULL, 774 },
+  { 0xd01fef10a657842cULL, 800 }, { 0x9b10a4e5e9913129ULL, 827 },
+  { 0xe7109bfba19c0c9dULL, 853 }, { 0xac2820d9623bf429ULL, 880 },
+  { 0x80444b5e7aa7cf85ULL, 907 }, { 0xbf21e44003acdd2dULL, 933 },
+  { 0x8e679c2f5e44ff8fULL, 960 }, { 0xd433179d9c8cb841ULL, 986 },
+  { 0x9e19db92b4e31ba9ULL, 1013 }, { 0xeb96bf6ebadf77d9ULL, 1039 },
+  { 0xaf87023b9bf0ee6bULL, 1066 }
+};
+
+/**
+ * Return the product of a and b, rounded to 64 bits.
+ */
+static inline DiyFp multiply(DiyFp a, DiyFp b) {
+  const unsigned long long M32 = 0xFFFFFFFFULL;
+  unsigned long long ah = a.f >> 32, al = a.f & M32;
+  unsigned long long bh = b.f >> 32, bl = b.f & M32;
+  unsigned long long hh = ah * bh, hl = ah * bl, lh = al * bh, ll = al * bl;
+  unsigned long long mid = (ll >> 32) + (hl & M32) + (lh & M32) + (1ULL << 31);
+
+  DiyFp result = { hh + (hl >> 32) + (lh >> 32) + (mid >> 32), a.e + b.e + 64 };
+  return result;
+}
+
+/**
+ * Shift x left until the top bit of its significand is set.
+ */
+static inline DiyFp normalize(DiyFp x) {
+  while (!(x.f & (1ULL << 63))) {
+    x.f <<= 1;
+    x.e--;
+  }
+  return x;
+}
+
+/**
+ * Remove the last digit of buf (of len digits) while doing so brings it
+ * closer to the value being converted and keeps it within its rounding
+ * interval.  rest is the distance from the digits to the top of the
+ * interval, delta its width, unit the value of the last digit and
+ * distance the distance from the exact value to the top.
+ */
+static inline void roundDigits(char* buf, size_t len, unsigned long long delta,
+                               unsigned long long rest, unsigned long long unit,
+                               unsigned long long distance) {
+  while (rest < distance && delta - rest >= unit &&
+         (rest + unit < distance || distance - rest > rest + unit - distance)) {
+    buf[len - 1]--;
+    rest += unit;
+  }
+}
+
+/**
+ * Write the shortest digits of value (which must be positive and
+ * finite) that fall within its rounding interval to buf, using the
+ * Grisu2 algorithm of Florian Loitsch.  Returns the number of digits,
+ * and sets exponent to the power of ten they are multiplied by.  The
+ * digits always convert back to value, and are the shortest possible
+ * in all but a small fraction of cases.
+ */
+static size_t shortestDigits(char* buf, double value, int& exponent) {
+  static const unsigned POWERS[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+  };
+
+  // value as f * 2^e
+  unsigned long long bits;
+  memcpy(&bits, &value, sizeof(bits));
+  int biased = (int)((bits >> 52) & 0x7FF);
+  DiyFp v = { bits & 0xFFFFFFFFFFFFFULL, -1074 };
+  if (biased) {
+    v.f |= 1ULL << 52;
+    v.e = biased - 1075;
+  }
+
+  // the interval of numbers that round to value, with the same exponent
+  DiyFp upper = { (v.f << 1) + 1, v.e - 1 };
+  while (!(upper.f & (1ULL << 53))) {
+    upper.f <<= 1;
+    upper.e--;
+  }
+  upper.f <<= 10;
+  upper.e -= 10;
+  DiyFp lower = (v.f == (1ULL << 52)) ?
+    DiyFp{ (v.f << 2) - 1, v.e - 2 } : DiyFp{ (v.f << 1) - 1, v.e - 1 };
+  lower.f <<= lower.e - upper.e;
+  lower.e = upper.e;
+
+  // scale by a power of ten that brings the exponent to [-60, -32]
+  double dk = (-61 - upper.e) * 0.30102999566398114 + 347;
+  int k = (int)dk;
+  if (dk - k > 0)
+    k++;
+  unsigned index = (unsigned)((k >> 3) + 1);
+  DiyFp power = CACHED_POWERS[index];
+  exponent = 348 - (int)(index << 3);
+
+  DiyFp w = multiply(normalize(v), power);
+  DiyFp high = multiply(upper, power);
+  DiyFp low = multiply(lower, power);
+  high.f--;
+  low.f++;
+  unsigned long long delta = high.f - low.f;
+
+  // generate digits of the integer part, then the fraction
+  int shift = -high.e;
+  unsigned long long one = 1ULL << shift;
+  unsigned long long distance = high.f - w.f;
+  unsigned integer = (unsigned)(high.f >> shift);
+  unsigned long long fraction = high.f & (one - 1);
+  int kappa = 10;
+  while (kappa > 1 && integer < POWERS[kappa - 1])
+    kappa--;
+  size_t len = 0;
+
+  while (kappa > 0) {
+    unsigned d = integer / POWERS[kappa - 1];
+    integer %= POWERS[kappa - 1];
+    if (d || len)
+      buf[len++] = (char)('0' + d);
+    kappa--;
+
+    unsigned long long rest = ((unsigned long long)integer << shift) + fraction;
+    if (rest <= delta) {
+      exponent += kappa;
+      roundDigits(buf, len, delta, rest,
+                  (unsigned long long)POWERS[kappa] << shift, distance);
+      return len;
+    }
+  }
+
+  for (;;) {
+    fraction *= 10;
+    delta *= 10;
+    unsigned d = (unsigned)(fraction >> shift);
+    if (d || len)
+      buf[len++] = (char)('0' + d);
+    fraction &= one - 1;
+    kappa--;
+
+    if (fraction < delta) {
+      exponent += kappa;
+      roundDigits(buf, len, delta, fraction, one,
+                  -kappa < 10 ? distance * POWERS[-kappa] : 0);
+      return len;
+    }
+  }
+}
+
+/**
+ * Return the number of decimal digits in value.
+ */
+static inline size_t countDigits(unsigned long long value) {
+  size_t n = 1;
+  for (;;) {
+    if (value < 10)    return n;
+    if (value < 100)   return n + 1;
+    if (value < 1000)  return n + 2;
+    if (value < 10000) return n + 3;
+    value /= 10000;
+    n += 4;
+  }
+}
+
+#ifndef _MCL_BIG_ENDIAN
+/**
+ * Return true if the eight bytes of chunk (loaded from memory on a
+ * little-endian processor) are all decimal digits.  A byte is a digit
+ * if its high half is 3, and still is after adding 6 to it.
+ */
+static inline bool isEightDigits(unsigned long long chunk) {
+  return ((chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+          (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4))
+    == 0x3333333333333333ULL;
+}
+
+/**
+ * Return the value of the eight digits in chunk.  Adjacent digits are
+ * combined into pairs, then pairs into fours, and fours into the
+ * result, with one multiplication at each step.
+ */
+static inline unsigned long long eightDigits(unsigned long long chunk) {
+  const unsigned long long mask = 0x000000FF000000FFULL;
+  const unsigned long long mul1 = 100 + (1000000ULL << 32);
+  const unsigned long long mul2 = 1 + (10000ULL << 32);
+
+  chunk -= 0x3030303030303030ULL;
+  chunk = (chunk * 10) + (chunk >> 8);
+  return (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+}
+#endif
+
+/**
+ * Append up to max decimal digits from p (up to end) to value, eight at
+ * a time where possible, stopping at the first character that is not a
+ * digit.  Returns the position following the last digit used.  The
+ * caller ensures value cannot overflow.
+ */
+static inline const char* parseDigits(const char* p, const char* end,
+                                      size_t max, unsigned long long& value) {
+#ifndef _MCL_BIG_ENDIAN
+  while (max >= 8 && end - p >= 8) {
+    unsigned long long chunk;
+    memcpy(&chunk, p, 8);
+    if (!isEightDigits(chunk))
+      break;
+
+    value = value * 100000000ULL + eightDigits(chunk);
+    p += 8;
+    max -= 8;
+  }
+#endif
+
+  while (max && p < end && (unsigned char)(*p - '0') <= 9) {
+    value = value * 10 + (unsigned)(*p - '0');
+    p++;
+    max--;
+  }
+
+  return p;
+}
+
+/**
+ * Return the value of the digits from p to end (there must be at
+ * least one), throwing a NumberFormatException if there is anything
+ * else, or an IntegerWrapException if the value is too large.
+ */
+static unsigned long long parseUnsigned(const char* p, const char* end) {
+  if (p == end)
+    throw NumberFormatException();
+
+  // leading zeros are not significant
+  while (end - p > 1 && *p == '0')
+    p++;
+
+  // nineteen digits always fit, and a twentieth might
+  unsigned long long value = 0;
+  p = parseDigits(p, end, 19, value);
+  if (p == end)
+    return value;
+
+  unsigned d = (unsigned char)(*p - '0');
+  if (d > 9)
+    throw NumberFormatException();
+  bool wrapped = value > (ULLONG_MAX - d) / 10;
+  value = value * 10 + d;
+
+  for (p++; p < end; p++) {
+    if ((unsigned char)(*p - '0') > 9)
+      throw NumberFormatException();
+    wrapped = true;
+  }
+
+  if (wrapped)
+    throw IntegerWrapException();
+
+  return value;
+}
+
+/**
+ * Write the decimal digits of value to buf, returning how many there
+ * are.  The digits are written from the end, two at a time.
+ */
+size_t format_uint(char* buf, unsigned long long value) {
+  size_t len = countDigits(value);
+  char* p = buf + len;
+
+  while (value >= 100) {
+    unsigned i = (unsigned)(value % 100) * 2;
+    value /= 100;
+    *--p = DIGIT_PAIRS[i + 1];
+    *--p = DIGIT_PAIRS[i];
+  }
+
+  if (value >= 10) {
+    unsigned i = (unsigned)value * 2;
+    *--p = DIGIT_PAIRS[i + 1];
+    *--p = DIGIT_PAIRS[i];
+  } else {
+    *--p = (char)('0' + value);
+  }
+
+  return len;
+}
+
+/**
+ * Write the decimal representation of value to buf, preceded by a minus
+ * sign if it is negative, returning its length.
+ */
+size_t format_int(char* buf, long long value) {
+  if (value >= 0)
+    return format_uint(buf, (unsigned long long)value);
+
+  // negate as unsigned, which is also correct for the most negative value
+  *buf = '-';
+  return 1 + format_uint(buf + 1, 0ULL - (unsigned long long)value);
+}
+
+/**
+ * Write the shortest decimal representation of value that converts
+ * back to exactly the same value to buf, returning its length.
+ * Integers of up to 2^53 are written as integers.  Other values are
+ * written like printf's %g conversion, but with the digits found by
+ * shortestDigits() rather than a fixed precision: with an exponent
+ * ("1.5e+300") if it is less than -4 or greater than 16, and otherwise
+ * without ("0.001", "123.25").  Infinities and NaN are written as
+ * "inf", "-inf" and "nan".
+ */
+size_t format_double(char* buf, double value) {
+  if (value != value) {
+    memcpy(buf, "nan", 3);
+    return 3;
+  }
+
+  if (value >= -EXACT_INTEGER_LIMIT && value <= EXACT_INTEGER_LIMIT &&
+      value == (double)(long long)value) {
+    if (value == 0 && signbit(value)) {
+      memcpy(buf, "-0", 2);
+      return 2;
+    }
+    return format_int(buf, (long long)value);
+  }
+
+  char* p = buf;
+  if (value < 0) {
+    *p++ = '-';
+    value = -value;
+  }
+
+  if (isinf(value)) {
+    memcpy(p, "inf", 3);
+    return p + 3 - buf;
+  }
+
+  char digits[20];
+  int exponent;
+  size_t len = shortestDigits(digits, value, exponent);
+  int point = (int)len + exponent;  // digits before the decimal point
+
+  if (point > 17 || point < -3) {
+    *p++ = digits[0];
+    if (len > 1) {
+      *p++ = '.';
+      memcpy(p, digits + 1, len - 1);
+      p += len - 1;
+    }
+    *p++ = 'e';
+    int e = point - 1;
+    *p++ = (e < 0) ? '-' : '+';
+    if (e < 0)
+      e = -e;
+    if (e < 10)
+      *p++ = '0';
+    p += format_uint(p, (unsigned long long)e);
+  } else if (exponent >= 0) {
+    memcpy(p, digits, len);
+    memset(p + len, '0', exponent);
+    p += point;
+  } else if (point > 0) {
+    memcpy(p, digits, point);
+    p[point] = '.';
+    memcpy(p + point + 1, digits + point, len - point);
+    p += len + 1;
+  } else {
+    *p++ = '0';
+    *p++ = '.';
+    memset(p, '0', -point);
+    memcpy(p - point, digits, len);
+    p += len - point;
+  }
+
+  return p - buf;
+}
+
+/**
+ * Return the value of the unsigned decimal integer in the len
+ * characters at str, which may begin with a plus sign.  An
+ * IntegerWrapException is thrown if it is too large.
+ */
+unsigned long long parse_uint(const char* str, size_t len) {
+  const char* end = str + len;
+  if (str < end && *str == '+')
+    str++;
+
+  return parseUnsigned(str, end);
+}
+
+/**
+ * Return the value of the decimal integer in the len characters at
+ * str, which may begin with a plus or minus sign.  An
+ * IntegerWrapException is thrown if it is too large or too small.
+ */
+long long parse_int(const char* str, size_t len) {
+  const char* end = str + len;
+  bool negative = false;
+  if (str < end && (*str == '+' || *str == '-')) {
+    negative = (*str == '-');
+    str++;
+  }
+
+  unsigned long long magnitude = parseUnsigned(str, end);
+  if (negative) {
+    if (magnitude > (unsigned long long)LLONG_MAX + 1)
+      throw IntegerWrapException();
+    return (long long)(0ULL - magnitude);
+  }
+
+  if (magnitude > (unsigned long long)LLONG_MAX)
+    throw IntegerWrapException();
+  return (long long)magnitude;
+}
+
+/**
+ * Return the value of the floating-point number in the len characters
+ * at str, in any of the forms strtod() accepts (other than with leading
+ * white space).  A NumberFormatException is also thrown if the value
+ * is too large for a double.
+ *
+ * Numbers without an exponent and with at most 15 significant digits
+ * (such as "-123.25") are converted directly: both the digits and the
+ * power of ten they are divided by are exactly representable, so a
+ * single division rounds correctly.  Anything else is passed to
+ * strtod().
+ */
+double parse_double(const char* str, size_t len) {
+  const char* p = str;
+  const char* end = str + len;
+  bool negative = false;
+  if (p < end && (*p == '+' || *p == '-')) {
+    negative = (*p == '-');
+    p++;
+  }
+
+  const char* digits = p;
+  while (p < end && *p == '0')
+    p++;
+
+  unsigned long long mantissa = 0;
+  const char* q = parseDigits(p, end, 15, mantissa);
+  size_t used = q - p;
+  size_t fraction = 0;
+  bool point = false;
+  p = q;
+
+  if (p < end && *p == '.') {
+    point = true;
+    p++;
+    q = parseDigits(p, end, 15 - used, mantissa);
+    fraction = q - p;
+    p = q;
+  }
+
+  // there must be at least one digit (zeros included)
+  if (p == end && (size_t)(p - digits) > (point ? 1u : 0u)) {
+    double value = (double)mantissa / POWERS_OF_TEN[fraction];
+    return negative ? -value : value;
+  }
+
+  // everything else is converted by strtod(), which needs a terminator
+  char local[64];
+  char* buf = local;
+  if (len >= sizeof(local)) {
+    buf = static_cast<char*>(malloc(len + 1));
+    if (!buf)
+      throw OutOfMemoryException();
+  }
+  memcpy(buf, str, len);
+  buf[len] = 0;
+
+  char* stop = 0;
+  errno = 0;
+  double value = strtod(buf, &stop);
+  bool valid = len && stop == buf + len &&
+    !(buf[0] == ' ' || (buf[0] >= '\t' && buf[0] <= '\r')) &&
+    !(errno == ERANGE && isinf(value));
+
+  if (buf != local)
+    free(buf);
+
+  if (!valid)
+    throw NumberFormatException();
+
+  return value;
+}
+
+} // namespace
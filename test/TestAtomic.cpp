@@ -0,0 +1,107 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <assert.h>
+
+#include <thread>
+
+#include <mcl/Atomic.h>
+
+using namespace mcl;
+
+
+/**
+ * Single-threaded operations
+ */
+void testOperations() {
+  Atomic<int> value(5);
+  assert(value.load() == 5);
+  assert(value.load(MEMORY_RELAXED) == 5);
+
+  value.store(7);
+  assert(value.load(MEMORY_ACQUIRE) == 7);
+  value.store(8, MEMORY_RELEASE);
+  assert(value.load() == 8);
+
+  assert(value.fetchAdd(2) == 8);
+  assert(value.fetchSub(1, MEMORY_ACQ_REL) == 10);
+  assert(value.load() == 9);
+
+  assert(value.exchange(3) == 9);
+  assert(value.load() == 3);
+
+  int expected = 4;
+  assert(!value.compareExchange(expected, 6));
+  assert(expected == 3);
+  while (!value.compareExchange(expected, 6))
+    ;
+  assert(value.load() == 6);
+
+  Atomic<int> zero;
+  assert(zero.load() == 0);
+
+  Atomic<bool> flag;
+  assert(!flag.load());
+  flag.store(true, MEMORY_RELAXED);
+  assert(flag.load());
+
+  int first = 1;
+  int second = 2;
+  Atomic<int*> ptr(&first);
+  assert(ptr.exchange(&second, MEMORY_ACQUIRE) == &first);
+  int* expectedPtr = &first;
+  assert(!ptr.compareExchange(expectedPtr, &first));
+  assert(expectedPtr == &second);
+  while (!ptr.compareExchange(expectedPtr, &first, MEMORY_RELEASE))
+    ;
+  assert(ptr.load() == &first);
+}
+
+/**
+ * Concurrent increments and decrements
+ */
+void testThreads() {
+  Atomic<int> counter(0);
+  std::thread threads[4];
+
+  for (int t = 0; t < 4; t++) {
+    threads[t] = std::thread([&counter, t]() {
+        for (int i = 0; i < 100000; i++) {
+          counter.fetchAdd(2, MEMORY_RELAXED);
+          counter.fetchSub(1, MEMORY_ACQ_REL);
+        }
+      });
+  }
+  for (int t = 0; t < 4; t++)
+    threads[t].join();
+
+  assert(counter.load() == 400000);
+
+  // compare and exchange loops
+  Atomic<int> total(0);
+  for (int t = 0; t < 4; t++) {
+    threads[t] = std::thread([&total]() {
+        for (int i = 0; i < 10000; i++) {
+          int value = total.load(MEMORY_RELAXED);
+          while (!total.compareExchange(value, value + 3, MEMORY_ACQ_REL))
+            ;
+        }
+      });
+  }
+  for (int t = 0; t < 4; t++)
+    threads[t].join();
+
+  assert(total.load() == 120000);
+}
+
+int main(int argc, char** argv) {
+
+    testOperations();
+    testThreads();
+
+    return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,230 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <mcl/Deque.h>
+#include <mcl/String.h>
+
+using namespace mcl;
+
+typedef Deque<int> IntDeque;
+
+/**
+ * An item that counts its live instances
+ */
+struct Counted {
+  static int live;
+  int value;
+
+  Counted(int v = 0) : value(v) { live++; }
+  Counted(const Counted& c) : value(c.value) { live++; }
+  ~Counted() { live--; }
+  bool operator!=(const Counted& c) const { return value != c.value; }
+};
+
+int Counted::live = 0;
+
+/**
+ * Constructor tests
+ */
+void testConstructor() {
+  IntDeque empty;
+  assert(empty.size() == 0);
+  assert(empty.capacity() == 16);
+
+  IntDeque rounded(100);
+  assert(rounded.capacity() == 128);
+
+  IntDeque none(0);
+  assert(none.capacity() == 0);
+  none.push(1);
+  assert(none[0] == 1);
+
+  IntDeque copy1;
+  copy1.push(1);
+  copy1.unshift(0);
+  copy1.push(2);
+  IntDeque copy2(copy1);
+  assert(copy2.size() == 3);
+  assert(copy2[0] == 0);
+  assert(copy2[1] == 1);
+  assert(copy2[2] == 2);
+  assert(copy2 == copy1);
+
+  IntDeque emptyCopy(empty);
+  assert(emptyCopy.size() == 0);
+  assert(emptyCopy.capacity() == 0);
+  assert(emptyCopy == empty);
+  emptyCopy.push(3);
+  emptyCopy.unshift(2);
+  assert(emptyCopy[0] == 2 && emptyCopy[1] == 3);
+}
+
+/**
+ * push(), pop(), shift() and unshift() tests
+ */
+void testEnds() {
+  IntDeque d(4);
+  d.push(2);
+  d.push(3);
+  d.unshift(1);
+  d.unshift(0);
+  assert(d.size() == 4);
+  assert(d.capacity() == 4);
+  for (int i = 0; i < 4; i++)
+    assert(d[i] == i);
+
+  // growing while the items wrap around the end of the array
+  d.push(4);
+  d.unshift(-1);
+  assert(d.capacity() == 8);
+  assert(d.size() == 6);
+  for (int i = 0; i < 6; i++)
+    assert(d[i] == i - 1);
+
+  assert(d.shift() == -1);
+  assert(d.pop() == 4);
+  assert(d.removeFirst() == 0);
+  assert(d.removeLast() == 3);
+  assert(d.size() == 2);
+  assert(d[0] == 1 && d[1] == 2);
+
+  d.item(1) = 20;
+  assert(d[1] == 20);
+
+  d.clear();
+  assert(d.size() == 0);
+
+  try {
+    d.pop();
+    fprintf(stderr, "Did not generate OutOfBoundsException on empty pop().\n");
+    exit(1);
+  } catch (OutOfBoundsException&) {
+    // expected
+  }
+
+  try {
+    d.shift();
+    fprintf(stderr, "Did not generate OutOfBoundsException on empty shift().\n");
+    exit(1);
+  } catch (OutOfBoundsException&) {
+    // expected
+  }
+
+  try {
+    d.item(0);
+    fprintf(stderr, "Did not generate OutOfBoundsException on invalid item() access.\n");
+    exit(1);
+  } catch (OutOfBoundsException&) {
+    // expected
+  }
+}
+
+/**
+ * A queue that items pass through many times the length of its array
+ */
+void testQueue() {
+  IntDeque q(8);
+  int next = 0;
+  int expected = 0;
+
+  for (int round = 0; round < 1000; round++) {
+    for (int i = 0; i < 5; i++)
+      q.push(next++);
+    for (int i = 0; i < 4; i++)
+      assert(q.shift() == expected++);
+  }
+  assert(q.size() == 1000);
+  assert(q.capacity() == 1024);
+  for (size_t i = 0; i < q.size(); i++)
+    assert(q[i] == expected + (int)i);
+
+  // the other direction
+  IntDeque stack;
+  for (int i = 0; i < 100; i++)
+    stack.unshift(i);
+  for (int i = 0; i < 100; i++)
+    assert(stack.pop() == i);
+}
+
+/**
+ * Items that are not plain values
+ */
+void testItems() {
+  const char* text = "a string long enough to be shared by copies";
+
+  Deque<String> strings(2);
+  String s(text);
+  strings.push(s);
+  strings.push(String("second"));
+  strings.unshift(strings[1]);
+  strings.push(strings[0]);
+  assert(strings.size() == 4);
+  assert(strings[0] == "second");
+  assert(strings[1].data() == s.data());
+  assert(strings[3] == "second");
+  strings.emplace('x', 3);
+  strings.emplaceFront(text, 1);
+  assert(strings[0] == "a");
+  assert(strings[5] == "xxx");
+
+  Deque<String> moved(std::move(strings));
+  assert(strings.size() == 0);
+  assert(moved.size() == 6);
+  strings = moved;
+  assert(strings == moved);
+  moved = std::move(strings);
+  assert(moved.size() == 6);
+  assert(moved.shift() == "a");
+
+  {
+    Deque<Counted> counted(4);
+    for (int i = 0; i < 50; i++) {
+      counted.push(Counted(i));
+      counted.unshift(Counted(-i));
+    }
+    counted.shift();
+    counted.pop();
+    assert(Counted::live == 98);
+
+    Deque<Counted> copy;
+    copy = counted;
+    assert(Counted::live == 196);
+    assert(copy == counted);
+    copy.clear();
+    assert(Counted::live == 98);
+  }
+  assert(Counted::live == 0);
+}
+
+/**
+ * reserve() tests
+ */
+void testReserve() {
+  IntDeque d(4);
+  d.push(1);
+  d.unshift(0);
+  d.reserve(100);
+  assert(d.capacity() == 128);
+  assert(d[0] == 0 && d[1] == 1);
+  d.reserve(10);
+  assert(d.capacity() == 128);
+}
+
+int main(int argc, char** argv) {
+
+  testConstructor();
+  testEnds();
+  testQueue();
+  testItems();
+  testReserve();
+
+  return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
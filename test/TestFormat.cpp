@@ -0,0 +1,220 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <assert.h>
+#include <limits.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <thread>
+
+#include <mcl/Format.h>
+#include <mcl/StringArena.h>
+#include <mcl/StringBuilder.h>
+#include <mcl/FormatException.h>
+
+using namespace mcl;
+
+
+/**
+ * Return true if formatting with fmt and value matches snprintf
+ */
+template <typename T>
+bool matchesPrintf(const char* fmt, T value) {
+  char expected[512];
+  snprintf(expected, sizeof(expected), fmt, value);
+  return String::format(fmt, value) == expected;
+}
+
+/**
+ * Return true if String::format(fmt, args...) throws a FormatException
+ */
+template <typename... Args>
+bool throwsFormat(const char* fmt, const Args&... args) {
+  try {
+    String::format(fmt, args...);
+  } catch (FormatException& e) {
+    return true;
+  }
+  return false;
+}
+
+/**
+ * Literal text and the kinds of argument
+ */
+void testFormat() {
+  assert(String::format("") == "");
+  assert(String::format("no conversions") == "no conversions");
+  assert(String::format("100%%") == "100%");
+
+  String name("mcl");
+  assert(String::format("%s-%s", name, "lib") == "mcl-lib");
+  assert(String::format("%d %u %c", -5, 7U, 'x') == "-5 7 x");
+  assert(String::format("%s %s %s %s", 42, -3LL, 'c', 0.1) == "42 -3 c 0.1");
+  assert(String::format("%ld %lld %zu", 1L, 2LL, (size_t)3) == "1 2 3");
+  assert(String::format("%s", (const char*)0) == "(null)");
+
+  // embedded nulls are kept
+  String nulls("a\0b", 3);
+  assert(String::format("[%s]", nulls).size() == 5);
+
+  // long results
+  String big('z', 1000);
+  String result = String::format("%s|%s|%d", big, big, 12345);
+  assert(result.size() == 2007);
+  assert(result.endsWith("z|12345"));
+  assert(result.count('z') == 2000);
+
+  // a StringBuilder can be appended to
+  StringBuilder b;
+  b.append("total: ");
+  FormatArg args[] = { FormatArg(3), FormatArg("items") };
+  Format("%d %s").append(b, args, 2);
+  assert(b.toString() == "total: 3 items");
+}
+
+/**
+ * Flags, widths and precisions
+ */
+void testConversions() {
+  assert(matchesPrintf("%5d|", 42));
+  assert(matchesPrintf("%-5d|", 42));
+  assert(matchesPrintf("%05d", -42));
+  assert(matchesPrintf("%+d", 42));
+  assert(matchesPrintf("% d", 42));
+  assert(matchesPrintf("%.4d", 7));
+  assert(matchesPrintf("%8.4d", -7));
+  assert(matchesPrintf("%.0d|", 0));
+  assert(matchesPrintf("%lld", LLONG_MIN));
+  assert(matchesPrintf("%llu", ULLONG_MAX));
+  assert(matchesPrintf("%x", 255));
+  assert(matchesPrintf("%#X", 255));
+  assert(matchesPrintf("%#x", 0));
+  assert(matchesPrintf("%08x", 0xbeef));
+  assert(matchesPrintf("%o", 8));
+  assert(matchesPrintf("%#o", 8));
+  assert(matchesPrintf("%#o", 0));
+  assert(matchesPrintf("%x", -1));
+  assert(matchesPrintf("%llx", -1LL));
+  assert(matchesPrintf("%hx", (short)-2));
+  assert(matchesPrintf("%x", (short)-2));
+  assert(matchesPrintf("%x", (char)-1));
+  assert(matchesPrintf("%o", (signed char)-1));
+  assert(matchesPrintf("%hhx", -1));
+  assert(matchesPrintf("%hx", -2));
+  assert(matchesPrintf("%#hho", (char)-8));
+  assert(matchesPrintf("%3c|", 'a'));
+  assert(matchesPrintf("%-3c|", 'a'));
+  assert(matchesPrintf("%c", 65));
+  assert(matchesPrintf("%10s|", "right"));
+  assert(matchesPrintf("%-10s|", "left"));
+  assert(matchesPrintf("%.3s", "truncated"));
+  assert(matchesPrintf("%f", 3.25));
+  assert(matchesPrintf("%.2f", 2.675));
+  assert(matchesPrintf("%10.3e", -12345.678));
+  assert(matchesPrintf("%g", 1e-10));
+  assert(matchesPrintf("%G", 1e300));
+  assert(matchesPrintf("%+08.2f", 3.14159));
+  assert(matchesPrintf("%f", 1e300));
+
+  // integers may be given to floating-point conversions
+  assert(String::format("%.1f", 3) == "3.0");
+  assert(String::format("%s", 2.5) == "2.5");
+  assert(String::format("%6s|", 2.5) == "   2.5|");
+}
+
+/**
+ * Errors in the format string or arguments
+ */
+void testErrors() {
+  assert(throwsFormat("%d"));
+  assert(throwsFormat("%d", 1, 2));
+  assert(throwsFormat("no conversions", 1));
+  assert(throwsFormat("%d", "text"));
+  assert(throwsFormat("%x", 1.5));
+  assert(throwsFormat("%f", String("1.5")));
+  assert(throwsFormat("%c", "c"));
+  assert(throwsFormat("%", 1));
+  assert(throwsFormat("%5", 1));
+  assert(throwsFormat("%y", 1));
+  assert(throwsFormat("%*d", 5, 1));
+  assert(throwsFormat("%999999999d", 1));
+
+  bool thrown = false;
+  try {
+    Format bad("value: %q");
+  } catch (FormatException& e) {
+    thrown = true;
+  }
+  assert(thrown);
+}
+
+/**
+ * Parsed and cached formats
+ */
+void testCache() {
+  Format fmt("%s=%d;");
+  assert(fmt.arguments() == 2);
+  assert(fmt.source() == "%s=%d;");
+  assert(String::format(fmt, "a", 1) == "a=1;");
+  assert(String::format(fmt, "b", 2) == "b=2;");
+
+  const char* literal = "cached %d";
+  const Format& first = Format::cached(literal);
+  assert(&Format::cached(literal) == &first);
+  assert(String::format(literal, 1) == "cached 1");
+  assert(&Format::cached(literal) == &first);
+
+  // a buffer reused for a different format is parsed again
+  char buf[32];
+  strcpy(buf, "first %d");
+  assert(String::format(buf, 1) == "first 1");
+  strcpy(buf, "second %s");
+  assert(String::format(buf, "x") == "second x");
+  strcpy(buf, "first %d!");
+  assert(String::format(buf, 2) == "first 2!");
+
+  // each thread has a cache of its own
+  String other;
+  std::thread t([&other, literal]() {
+      other = String::format(literal, 2);
+    });
+  t.join();
+  assert(other == "cached 2");
+  assert(String::format(literal, 3) == "cached 3");
+}
+
+/**
+ * Formats first used inside a StringArena
+ */
+void testArena() {
+  const char* literal = "a format long enough for the heap: %d";
+
+  {
+    StringArena arena;
+    String text("another format long enough for the heap: %s");
+    assert(text.inArena());
+    assert(String::format(literal, 1) == "a format long enough for the heap: 1");
+    Format fmt(text);
+    assert(String::format(fmt, "x").endsWith("heap: x"));
+    assert(!fmt.source().inArena());
+    assert(!Format::cached(literal).source().inArena());
+  }
+
+  assert(String::format(literal, 2) == "a format long enough for the heap: 2");
+}
+
+int main(int argc, char** argv) {
+
+    testFormat();
+    testConversions();
+    testErrors();
+    testCache();
+    testArena();
+
+    return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,299 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <assert.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <string>
+
+#include <mcl/Rope.h>
+#include <mcl/OutOfBoundsException.h>
+
+using namespace mcl;
+
+
+/**
+ * Return true if rope holds exactly the characters of expected
+ */
+static bool sameContent(const Rope& rope, const std::string& expected) {
+  if (rope.size() != expected.size())
+    return false;
+
+  String flat = rope.flatten();
+  return flat.size() == expected.size() &&
+    memcmp(flat.data(), expected.data(), expected.size()) == 0;
+}
+
+/**
+ * Return a string of len characters starting at c
+ */
+static std::string pattern(size_t len, char c) {
+  std::string s;
+  for (size_t i = 0; i < len; i++)
+    s += (char)('a' + (c - 'a' + i) % 26);
+  return s;
+}
+
+/**
+ * Constructor tests
+ */
+void testConstructors() {
+  Rope empty;
+  assert(empty.size() == 0);
+  assert(empty.depth() == 0);
+  assert(empty.flatten() == "");
+
+  Rope a("abc");
+  assert(a.size() == 3);
+  assert(a.flatten() == "abc");
+
+  String s("a string that is too long to be stored locally");
+  Rope b(s);
+  assert(b.size() == s.size());
+  // a single leaf flattens without copying
+  assert(b.flatten().data() == s.data());
+
+  Rope c(b);
+  assert(c.flatten() == s);
+
+  Rope d(std::move(c));
+  assert(d.flatten() == s);
+  assert(c.size() == 0);
+
+  Rope e(String(""));
+  assert(e.size() == 0);
+}
+
+/**
+ * concat() tests
+ */
+void testConcat() {
+  Rope a("hello");
+  Rope b(" world");
+  Rope c = a + b;
+  assert(c.flatten() == "hello world");
+  assert(a.flatten() == "hello");
+  assert(b.flatten() == " world");
+
+  assert((Rope() + a).flatten() == "hello");
+  assert((a + Rope()).flatten() == "hello");
+
+  // many small appends stay balanced
+  Rope r;
+  std::string expected;
+  for (int i = 0; i < 10000; i++) {
+    std::string piece = pattern(1 + i % 97, (char)('a' + i % 26));
+    r = r + Rope(piece.c_str());
+    expected += piece;
+  }
+  assert(sameContent(r, expected));
+  assert(r.depth() < 40);
+
+  // and so do prepends
+  Rope p;
+  expected.clear();
+  for (int i = 0; i < 10000; i++) {
+    std::string piece = pattern(70 + i % 13, (char)('a' + i % 26));
+    p = Rope(piece.c_str()) + p;
+    expected = piece + expected;
+  }
+  assert(sameContent(p, expected));
+  assert(p.depth() < 40);
+
+  // joining trees of very different heights
+  Rope q = r + Rope("x") + p;
+  assert(q.size() == r.size() + 1 + p.size());
+  assert(q.charAt(r.size()) == 'x');
+}
+
+/**
+ * charAt() tests
+ */
+void testCharAt() {
+  std::string expected;
+  Rope r;
+  for (int i = 0; i < 500; i++) {
+    std::string piece = pattern(100, (char)('a' + i % 26));
+    r = r + Rope(piece.c_str());
+    expected += piece;
+  }
+
+  for (size_t i = 0; i < expected.size(); i += 7)
+    assert(r.charAt(i) == expected[i]);
+  assert(r.charAt(expected.size() - 1) == expected[expected.size() - 1]);
+
+  bool thrown = false;
+  try {
+    r.charAt(expected.size());
+  } catch (OutOfBoundsException& e) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  thrown = false;
+  try {
+    Rope().charAt(0);
+  } catch (OutOfBoundsException& e) {
+    thrown = true;
+  }
+  assert(thrown);
+}
+
+/**
+ * substring() tests
+ */
+void testSubstring() {
+  std::string expected;
+  Rope r;
+  for (int i = 0; i < 300; i++) {
+    std::string piece = pattern(50 + i % 71, (char)('a' + i % 26));
+    r = r + Rope(piece.c_str());
+    expected += piece;
+  }
+
+  long len = (long)expected.size();
+  for (long from = 0; from < len; from += 997) {
+    for (long n = 0; from + n <= len; n += 1531) {
+      Rope sub = r.substring(from, n);
+      assert(sameContent(sub, expected.substr(from, n)));
+    }
+  }
+
+  assert(sameContent(r.substring(10), expected.substr(10)));
+  assert(sameContent(r.substring(-10), expected.substr(len - 10)));
+  assert(sameContent(r.substring(5, -5), expected.substr(5, len - 10)));
+  assert(sameContent(r.substring(0, len + 100), expected));
+  assert(r.substring(len + 1).size() == 0);
+
+  // substrings of substrings
+  Rope inner = r.substring(1000, 5000).substring(123, 2000);
+  assert(sameContent(inner, expected.substr(1123, 2000)));
+
+  Rope a("abcdef");
+  assert(a.substring(2, 2).flatten() == "cd");
+}
+
+/**
+ * insert() and remove() tests
+ */
+void testEdit() {
+  std::string expected = pattern(20000, 'a');
+  Rope r(expected.c_str());
+
+  unsigned int seed = 1;
+  for (int i = 0; i < 500; i++) {
+    seed = seed * 1103515245 + 12345;
+    size_t pos = (seed >> 8) % (expected.size() + 1);
+    if (i % 3 == 2) {
+      long n = (long)((seed >> 4) % 200);
+      r = r.remove((long)pos, n);
+      expected.erase(pos, n);
+    } else {
+      std::string piece = pattern(1 + (seed >> 16) % 150, 'n');
+      r = r.insert(pos, Rope(piece.c_str()));
+      expected.insert(pos, piece);
+    }
+  }
+  assert(sameContent(r, expected));
+  assert(r.depth() < 40);
+
+  assert(Rope("abc").insert(10, Rope("de")).flatten() == "abcde");
+  assert(Rope("abcdef").remove(1, 2).flatten() == "adef");
+  assert(Rope("abcdef").remove(-2, 2).flatten() == "abcd");
+}
+
+/**
+ * Iterator tests
+ */
+void testIterator() {
+  Rope empty;
+  Rope::Iterator none(empty);
+  String piece;
+  assert(!none.hasNext());
+  assert(!none.next(piece));
+
+  bool thrown = false;
+  try {
+    none.nextChar();
+  } catch (OutOfBoundsException& e) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  std::string expected;
+  Rope r;
+  for (int i = 0; i < 200; i++) {
+    std::string piece = pattern(90 + i % 11, (char)('a' + i % 26));
+    r = r + Rope(piece.c_str());
+    expected += piece;
+  }
+
+  // character at a time
+  Rope::Iterator chars(r);
+  std::string seen;
+  while (chars.hasNext())
+    seen += chars.nextChar();
+  assert(seen == expected);
+
+  // piece at a time, mixed with characters
+  Rope::Iterator pieces(r);
+  seen.clear();
+  seen += pieces.nextChar();
+  seen += pieces.nextChar();
+  while (pieces.next(piece))
+    seen.append(piece.data(), piece.size());
+  assert(seen == expected);
+
+  // the iterator keeps the rope alive
+  Rope::Iterator* kept;
+  {
+    Rope temporary = Rope("a string that is too long to be stored locally")
+      + Rope(" and another one that is also rather long");
+    kept = new Rope::Iterator(temporary);
+  }
+  seen.clear();
+  while (kept->next(piece))
+    seen.append(piece.data(), piece.size());
+  delete kept;
+  assert(seen == "a string that is too long to be stored locally"
+         " and another one that is also rather long");
+}
+
+/**
+ * Structure sharing
+ */
+void testSharing() {
+  String big(pattern(100000, 'a').c_str());
+  Rope r(big);
+
+  // slicing a leaf shares its data
+  Rope sub = r.substring(1000, 50000);
+  Rope::Iterator it(sub);
+  String piece;
+  assert(it.next(piece));
+  assert(piece.data() == big.data() + 1000);
+
+  // edits leave the original unchanged
+  Rope edited = r.insert(5000, Rope("inserted"));
+  assert(r.flatten() == big);
+  assert(edited.size() == big.size() + 8);
+}
+
+int main(int argc, char** argv) {
+
+    testConstructors();
+    testConcat();
+    testCharAt();
+    testSubstring();
+    testEdit();
+    testIterator();
+    testSharing();
+
+    return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,244 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <mcl/SmallVector.h>
+#include <mcl/String.h>
+
+using namespace mcl;
+
+typedef SmallVector<int, 4> IntList;
+
+/**
+ * An item that counts its live instances
+ */
+struct Counted {
+  static int live;
+  int value;
+
+  Counted(int v = 0) : value(v) { live++; }
+  Counted(const Counted& c) : value(c.value) { live++; }
+  ~Counted() { live--; }
+  bool operator!=(const Counted& c) const { return value != c.value; }
+};
+
+int Counted::live = 0;
+
+/**
+ * An item too large to be stored in the array
+ */
+struct Large {
+  char text[64];
+  int value;
+
+  Large(int v = 0) : value(v) { text[0] = 0; }
+  Large(const Large& l) : value(l.value) { text[0] = 0; }
+  bool operator!=(const Large& l) const { return value != l.value; }
+};
+
+/**
+ * Return the sum of the items of any Vector
+ */
+int sum(const Vector<int>& list) {
+  int total = 0;
+  for (size_t i = 0; i < list.size(); i++)
+    total += list[i];
+  return total;
+}
+
+/**
+ * Items kept in the object and moved to the heap
+ */
+void testStorage() {
+  IntList list;
+  assert(list.size() == 0);
+  assert(list.capacity() == 4);
+  assert(list.isInline());
+
+  for (int i = 0; i < 4; i++)
+    list.push(i);
+  assert(list.isInline());
+  assert(list.capacity() == 4);
+
+  list.push(4);
+  assert(!list.isInline());
+  assert(list.capacity() == 16);
+  for (int i = 0; i < 5; i++)
+    assert(list[i] == i);
+
+  list.shrinkToFit();
+  assert(list.capacity() == 5);
+  assert(list.shift() == 0);
+  assert(list.pop() == 4);
+
+  // the Vector interface
+  Vector<int>& v = list;
+  v.unshift(10);
+  v.insert(1, 11);
+  assert(sum(list) == 10 + 11 + 1 + 2 + 3);
+
+  IntList small;
+  small.push(1);
+  small.push(2);
+  assert(sum(small) == 3);
+
+  try {
+    small.item(2);
+    fprintf(stderr, "Did not generate OutOfBoundsException on invalid item() access.\n");
+    exit(1);
+  } catch (OutOfBoundsException&) {
+    // expected
+  }
+
+  // reserving beyond N moves the items
+  small.reserve(4);
+  assert(small.isInline());
+  small.reserve(5);
+  assert(!small.isInline());
+  assert(small.capacity() == 5);
+  assert(small[1] == 2);
+
+  // items stored by pointer
+  SmallVector<Large, 2> large;
+  large.emplace(1);
+  large.emplace(2);
+  assert(large.isInline());
+  large.unshift(Large(0));
+  assert(!large.isInline());
+  assert(large[0].value == 0 && large[2].value == 2);
+}
+
+/**
+ * Copying, moving and assigning, inline and on the heap
+ */
+void testCopy() {
+  IntList small;
+  small.push(1);
+  small.push(2);
+
+  IntList big;
+  for (int i = 0; i < 10; i++)
+    big.push(i);
+
+  IntList copy1(small);
+  assert(copy1.isInline());
+  assert(copy1 == small);
+
+  IntList copy2(big);
+  assert(!copy2.isInline());
+  assert(copy2.capacity() == 10);
+  assert(copy2 == big);
+
+  Vector<int> plain(big);
+  SmallVector<int, 16> copy3(plain);
+  assert(copy3.isInline());
+  assert(copy3 == plain);
+
+  // moving an inline list moves its items
+  IntList moved1(std::move(copy1));
+  assert(moved1.isInline());
+  assert(moved1.size() == 2);
+  assert(copy1.size() == 0);
+  assert(copy1.isInline());
+
+  // moving a list on the heap takes its array
+  IntList moved2(std::move(copy2));
+  assert(!moved2.isInline());
+  assert(moved2 == big);
+  assert(copy2.size() == 0);
+  assert(copy2.isInline());
+  copy2.push(5);
+  assert(copy2.isInline());
+
+  // to and from plain Vectors
+  Vector<int> fromSmall(std::move(moved1));
+  assert(fromSmall.size() == 2);
+  assert(fromSmall[1] == 2);
+  assert(moved1.size() == 0);
+
+  IntList fromPlain(std::move(plain));
+  assert(!fromPlain.isInline());
+  assert(fromPlain.size() == 10);
+  assert(plain.size() == 0);
+
+  Vector<int> assigned;
+  assigned = std::move(small);
+  assert(assigned.size() == 2);
+  assert(small.size() == 0);
+
+  // assignment
+  IntList target;
+  target = big;
+  assert(target == big);
+  target = assigned;
+  assert(target == assigned);
+  target = std::move(moved2);
+  assert(target == big);
+  target = std::move(target);
+  assert(target == big);
+
+  SmallVector<int, 2> tiny;
+  tiny.push(7);
+  IntList other;
+  other.push(1);
+  other.push(2);
+  other.push(3);
+  Vector<int>& asVector = other;
+  tiny = std::move(asVector);
+  assert(!tiny.isInline());
+  assert(tiny.size() == 3);
+}
+
+/**
+ * Items that are not plain values
+ */
+void testItems() {
+  const char* text = "a string long enough to be shared by copies";
+
+  {
+    SmallVector<Counted, 3> counted;
+    for (int i = 0; i < 3; i++)
+      counted.push(Counted(i));
+    assert(Counted::live == 3);
+
+    SmallVector<Counted, 3> copy(counted);
+    assert(Counted::live == 6);
+
+    counted.push(Counted(3));
+    assert(Counted::live == 7);
+
+    SmallVector<Counted, 3> moved(std::move(copy));
+    assert(Counted::live == 7);
+    moved.clear();
+    assert(Counted::live == 4);
+  }
+  assert(Counted::live == 0);
+
+  SmallVector<String, 2> strings;
+  String s(text);
+  strings.push(s);
+  strings.push(strings[0]);
+  strings.push(strings[1]);
+  assert(strings.size() == 3);
+  assert(strings[2].data() == s.data());
+  strings.emplaceAt(0, 'x', 2);
+  assert(strings[0] == "xx");
+  assert(strings.remove(0) == "xx");
+  assert(strings[0] == text);
+}
+
+int main(int argc, char** argv) {
+
+  testStorage();
+  testCopy();
+  testItems();
+
+  return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
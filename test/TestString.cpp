@@ -2,11 +2,22 @@
 // See the LICENSE file distributed with this work for restrictions.
 
 #include <assert.h>
+#include <limits.h>
+#include <math.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include <thread>
 
 #include <mcl/String.h>
+#include <mcl/IOException.h>
+#include <mcl/IntegerWrapException.h>
+#include <mcl/NumberFormatException.h>
+#include <mcl/Vector.h>
+#include <mcl/hash_functions.h>
 
 using namespace mcl;
 
@@ -70,6 +81,63 @@ void testConstructor() {
   assert(strcmp(empty7, "") == 0);
 }
 
+/**
+ * StringRef::create() tests
+ */
+void testStringRefCreate() {
+  StringRef* ref = StringRef::create(3);
+  assert(ref->refCount.load() == 1);
+  assert(ref->size == 3);
+  assert(ref->data == (char*)(ref + 1));
+  assert(ref->data[3] == 0);
+  StringRef::destroy(ref);
+
+  String binary("a\0b", 3);
+  assert(binary.size() == 3);
+  assert(binary.charAt(1) == 0);
+  assert(binary.charAt(2) == 'b');
+  assert(binary.data()[3] == 0);
+}
+
+/**
+ * Tests of strings around the local storage limit
+ */
+void testLocalStorage() {
+  char buf[64];
+  for (size_t len = 0; len < sizeof(buf); len++) {
+    memset(buf, 'a' + (len % 26), len);
+    buf[len] = 0;
+
+    String str(buf);
+    assert(str.size() == len);
+    assert(strcmp(str, buf) == 0);
+
+    String copy(str);
+    assert(copy.size() == len);
+    assert(copy == str);
+    assert(copy.data()[len] == 0);
+
+    String assigned = "x";
+    assigned = str;
+    assert(assigned == str);
+    assigned = assigned;
+    assert(assigned == str);
+
+    String filled('z', len);
+    assert(filled.size() == len);
+    assert(filled.data()[len] == 0);
+  }
+
+  // assigning from our own data
+  String longString("abcdefghijklmnopqrstuvwxyz0123456789");
+  longString.assign(longString.data() + 1, 30);
+  assert(longString == "bcdefghijklmnopqrstuvwxyz01234");
+  longString.assign(longString, 2, 5);
+  assert(longString == "defgh");
+  longString.assign(longString.data() + 1, 3);
+  assert(longString == "efg");
+}
+
 /**
  * data() tests
  */
@@ -134,9 +202,541 @@ void testSubstring() {
   assert(letters.substring(1, -10) == "");
 }
 
+/**
+ * Substrings of shared data
+ */
+void testSharedSubstring() {
+  String line("2011-04-01 12:00:00 INFO connection accepted from 10.0.0.1");
+
+  // a suffix shares the original data
+  String suffix = line.substring(20);
+  assert(suffix == "INFO connection accepted from 10.0.0.1");
+  assert(suffix.data() == line.data() + 20);
+  assert(suffix.isTerminated());
+
+  // anything else is copied so that it is terminated
+  String middle = line.substring(0, 30);
+  assert(middle == "2011-04-01 12:00:00 INFO conne");
+  assert(middle.data() != line.data());
+  assert(middle.isTerminated());
+}
+
+/**
+ * slice() tests
+ */
+void testSlice() {
+  String line("2011-04-01 12:00:00 INFO connection accepted from 10.0.0.1");
+
+  String slice = line.slice(20, 30);
+  assert(slice.size() == 30);
+  assert(slice.data() == line.data() + 20);
+  assert(!slice.isTerminated());
+  assert(strncmp(slice, "INFO connection accepted from ", 30) == 0);
+
+  String sliceOfSlice = slice.slice(2, -2);
+  assert(sliceOfSlice.size() == 26);
+  assert(sliceOfSlice.data() == line.data() + 22);
+
+  String shortSlice = slice.slice(5, 10);
+  assert(shortSlice.isTerminated());
+  assert(shortSlice == "connection");
+
+  String terminated = slice.terminated();
+  assert(terminated.isTerminated());
+  assert(terminated == "INFO connection accepted from ");
+
+  String end = line.slice(-8, 8);
+  assert(end.isTerminated());
+  assert(end == "10.0.0.1");
+
+  String empty = line.slice(100, 5);
+  assert(empty.size() == 0);
+  assert(empty.isTerminated());
+
+  // compaction
+  String compacted = slice;
+  compacted.compact();
+  assert(compacted.data() != line.data() + 20);
+  assert(compacted.isTerminated());
+  assert(compacted == terminated);
+
+  // slices of a released string remain valid
+  line = "";
+  assert(strncmp(slice.data(), "INFO connection accepted from ", 30) == 0);
+}
+
 /**
  * operator=() tests
  */
+/**
+ * Strings referring to literal data
+ */
+void testLiteral() {
+  using namespace mcl::literals;
+
+  const char* text = "a literal that is longer than a local string";
+  String lit = String::literal(text, strlen(text));
+  assert(lit.data() == text);
+  assert(lit.size() == strlen(text));
+  assert(lit.isTerminated());
+  assert(lit == text);
+
+  String key = "Content-Type"_str;
+  assert(key.size() == 12);
+  assert(key == "Content-Type");
+  assert(key == String("Content-Type"));
+
+  // copies, slices and substrings share the literal data
+  String copy(lit);
+  assert(copy.data() == text);
+  String slice = lit.slice(2, 30);
+  assert(slice.data() == text + 2);
+  assert(!slice.isTerminated());
+  String tail = lit.substring(-30);
+  assert(tail.data() == text + strlen(text) - 30);
+  String moved(std::move(copy));
+  assert(moved.data() == text);
+  assert(copy.size() == 0);
+
+  // compacting a slice of a literal is unnecessary
+  slice.compact();
+  assert(slice.data() == text + 2);
+
+  assert(String::hash(lit) == String::hash(String(text)));
+  assert(String::hash(slice) == hash_string(text + 2, 30));
+
+  copy = lit;
+  copy = "x";
+  assert(copy == "x");
+  assert(lit.data() == text);
+
+  String embedded = "a\0b"_str;
+  assert(embedded.size() == 3);
+  assert(embedded.compare("a\0b", 3) == 0);
+}
+
+/**
+ * Immortal string references
+ */
+void testImmortal() {
+  const char* text = "a value shared for the life of the program";
+  String value(text);
+  const char* data = value.data();
+  value.makeImmortal();
+  assert(value.data() == data);
+  assert(value == text);
+
+  {
+    String copy(value);
+    String other;
+    other = copy;
+    assert(other.data() == data);
+  }
+  value = "something else";
+
+  // the data is still referenced by copies made before or after
+  String keep = String(text);
+  keep.makeImmortal();
+  String copy1(keep);
+  keep = "";
+  String copy2(copy1);
+  copy1 = "";
+  assert(copy2 == text);
+
+  // a slice keeps only its own characters
+  String slice = copy2.slice(2, 30);
+  slice.makeImmortal();
+  assert(slice.data() != copy2.data() + 2);
+  assert(slice.isTerminated());
+  assert(slice == String(text + 2, 30));
+
+  // local strings are unaffected
+  String local("short");
+  local.makeImmortal();
+  assert(local == "short");
+}
+
+/**
+ * Deleter counting the bytes it releases
+ */
+static void countingDeleter(char* data, size_t size, void* context) {
+  *(size_t*)context += size;
+  delete [] data;
+}
+
+/**
+ * Strings taking over external data
+ */
+void testAdopt() {
+  const char* text = "a buffer that is filled in by something else";
+  size_t len = strlen(text);
+  size_t released = 0;
+
+  char* buf = new char[len];
+  memcpy(buf, text, len);
+  {
+    String str(buf, len, countingDeleter, &released);
+    assert(str.data() == buf);
+    assert(str.size() == len);
+    assert(!str.isTerminated());
+    assert(str.terminated() == text);
+    assert(str == String(text));
+
+    String copy(str);
+    String slice = str.slice(2, 30);
+    assert(slice.data() == buf + 2);
+    str = "";
+    copy = "";
+    assert(released == 0);
+
+    // a substring to the end cannot share unterminated data
+    String tail = slice.substring(20);
+    assert(tail.isTerminated());
+    assert(tail == String(text + 22, 10));
+  }
+  assert(released == len);
+
+  // terminated data may be shared by substrings
+  released = 0;
+  buf = new char[len + 1];
+  memcpy(buf, text, len + 1);
+  {
+    String str(buf, len, countingDeleter, &released, true);
+    assert(str.isTerminated());
+    String tail = str.substring(10);
+    assert(tail.data() == buf + 10);
+    str.makeImmortal();
+  }
+  assert(released == 0);
+
+  // short data is copied and released immediately
+  released = 0;
+  buf = new char[5];
+  memcpy(buf, "short", 5);
+  String local(buf, 5, countingDeleter, &released);
+  assert(released == 5);
+  assert(local == "short");
+
+  // frozen data is never released
+  static char frozen[] = "static data that is never released by a String";
+  String kept(frozen, strlen(frozen), 0);
+  assert(kept.data() == frozen);
+  kept = "";
+  assert(strcmp(frozen, "static data that is never released by a String") == 0);
+}
+
+/**
+ * fromFile() tests
+ */
+void testFromFile() {
+  char path[] = "/tmp/TestStringXXXXXX";
+  int fd = mkstemp(path);
+  assert(fd >= 0);
+  FILE* fp = fdopen(fd, "w");
+  assert(fp);
+  for (int i = 0; i < 1000; i++)
+    fprintf(fp, "line %d of the file\n", i);
+  fclose(fp);
+
+  String contents = String::fromFile(path);
+  assert(contents.startsWith("line 0 of the file\n"));
+  assert(contents.endsWith("line 999 of the file\n"));
+  assert(contents.count('\n') == 1000);
+  assert(contents.isTerminated());
+
+  Vector<String> lines;
+  contents.split('\n', lines);
+  assert(lines.size() == 1001);
+  assert(lines[500] == "line 500 of the file");
+
+  // the mapping stays valid after the file is removed
+  remove(path);
+  String line = lines[999];
+  contents = "";
+  lines.clear();
+  assert(line == "line 999 of the file");
+
+  // a file filling whole pages is not followed by a null character
+  strcpy(path, "/tmp/TestStringXXXXXX");
+  fd = mkstemp(path);
+  assert(fd >= 0);
+  long page = sysconf(_SC_PAGESIZE);
+  String fill('x', (size_t)page);
+  assert(write(fd, fill.data(), fill.size()) == page);
+  close(fd);
+  String whole = String::fromFile(path);
+  assert(whole == fill);
+  assert(!whole.isTerminated());
+  assert(whole.terminated() == fill);
+  remove(path);
+
+  // empty files
+  strcpy(path, "/tmp/TestStringXXXXXX");
+  fd = mkstemp(path);
+  assert(fd >= 0);
+  close(fd);
+  assert(String::fromFile(path) == "");
+  remove(path);
+
+  bool thrown = false;
+  try {
+    String::fromFile("/nonexistent/TestString");
+  } catch (IOException& e) {
+    thrown = true;
+    assert(e.code() == ENOENT);
+  }
+  assert(thrown);
+}
+
+/**
+ * fromInt(), fromUInt() and fromDouble() tests
+ */
+void testFromNumber() {
+  char expected[64];
+
+  assert(String::fromInt(0) == "0");
+  assert(String::fromInt(-42) == "-42");
+  assert(String::fromUInt(1234567890123ULL) == "1234567890123");
+
+  sprintf(expected, "%lld", LLONG_MIN);
+  assert(String::fromInt(LLONG_MIN) == expected);
+  sprintf(expected, "%lld", LLONG_MAX);
+  assert(String::fromInt(LLONG_MAX) == expected);
+  sprintf(expected, "%llu", ULLONG_MAX);
+  assert(String::fromUInt(ULLONG_MAX) == expected);
+
+  // every number of digits
+  unsigned long long power = 1;
+  for (int i = 0; i < 20; i++, power *= 10) {
+    sprintf(expected, "%llu", power - 1);
+    assert(String::fromUInt(power - 1) == expected);
+    sprintf(expected, "%llu", power);
+    assert(String::fromUInt(power) == expected);
+  }
+
+  assert(String::fromDouble(0.0) == "0");
+  assert(String::fromDouble(-0.0) == "-0");
+  assert(String::fromDouble(3.0) == "3");
+  assert(String::fromDouble(-2.5) == "-2.5");
+  assert(String::fromDouble(0.1) == "0.1");
+  assert(String::fromDouble(1.0 / 3) == "0.3333333333333333");
+  assert(String::fromDouble(9007199254740992.0) == "9007199254740992");
+  assert(String::fromDouble(1e300) == "1e+300");
+  assert(String::fromDouble(5e-324).toDouble() == 5e-324);
+  assert(String::fromDouble(INFINITY) == "inf");
+  assert(String::fromDouble(-INFINITY) == "-inf");
+  assert(String::fromDouble(NAN) == "nan");
+
+  // the shortest representation converts back to the same value
+  srand(19);
+  for (int i = 0; i < 10000; i++) {
+    unsigned long long bits = 0;
+    for (int j = 0; j < 4; j++)
+      bits = (bits << 16) ^ (unsigned)rand();
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    if (value != value || isinf(value))
+      continue;
+
+    String s = String::fromDouble(value);
+    assert(s.toDouble() == value);
+    assert(s.size() <= 24);
+  }
+}
+
+/**
+ * toInt64(), toUInt64() and toDouble() tests
+ */
+void testToNumber() {
+  char buf[64];
+
+  assert(String("0").toInt64() == 0);
+  assert(String("-42").toInt64() == -42);
+  assert(String("+42").toInt64() == 42);
+  assert(String("000000000000000000000000123").toInt64() == 123);
+  assert(String("12345678901234567").toUInt64() == 12345678901234567ULL);
+
+  sprintf(buf, "%lld", LLONG_MIN);
+  assert(String(buf).toInt64() == LLONG_MIN);
+  sprintf(buf, "%lld", LLONG_MAX);
+  assert(String(buf).toInt64() == LLONG_MAX);
+  sprintf(buf, "%llu", ULLONG_MAX);
+  assert(String(buf).toUInt64() == ULLONG_MAX);
+
+  // digits of a slice are not read beyond its end
+  String digits("123456789012345678901234567890");
+  assert(digits.slice(0, 9).toInt64() == 123456789);
+  assert(digits.slice(3, 16).toUInt64() == 4567890123456789ULL);
+
+  srand(17);
+  for (int i = 0; i < 1000; i++) {
+    long long value = ((long long)rand() << 33) ^ ((long long)rand() << 12) ^
+      rand();
+    if (i & 1)
+      value = -value;
+    assert(String::fromInt(value).toInt64() == value);
+  }
+
+  const char* wrapping[] = {
+    "9223372036854775808", "-9223372036854775809", "18446744073709551616",
+    "99999999999999999999", "123456789012345678901234567890"
+  };
+  for (int i = 0; i < 5; i++) {
+    bool thrown = false;
+    try {
+      if (i == 2 || i == 3)
+        String(wrapping[i]).toUInt64();
+      else
+        String(wrapping[i]).toInt64();
+    } catch (IntegerWrapException& e) {
+      thrown = true;
+    }
+    assert(thrown);
+  }
+
+  const char* invalid[] = {
+    "", "-", "+", " 1", "1 ", "12a", "0x10", "--1", "1.0", "1234567890123456789x"
+  };
+  for (int i = 0; i < 10; i++) {
+    bool thrown = false;
+    try {
+      String(invalid[i]).toInt64();
+    } catch (NumberFormatException& e) {
+      thrown = true;
+    }
+    assert(thrown);
+  }
+
+  bool thrown = false;
+  try {
+    String("-1").toUInt64();
+  } catch (NumberFormatException& e) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  assert(String("0").toDouble() == 0.0);
+  assert(String("-2.5").toDouble() == -2.5);
+  assert(String("0.1").toDouble() == 0.1);
+  assert(String(".5").toDouble() == 0.5);
+  assert(String("5.").toDouble() == 5.0);
+  assert(String("123456789.012345").toDouble() == 123456789.012345);
+  assert(String("1e10").toDouble() == 1e10);
+  assert(String("1.7976931348623157e308").toDouble() == 1.7976931348623157e308);
+  assert(String("0.30000000000000004").toDouble() == 0.30000000000000004);
+  assert(String("inf").toDouble() == INFINITY);
+  assert(signbit(String("-0").toDouble()));
+  assert(String("3.25xyz").slice(0, 4).toDouble() == 3.25);
+
+  const char* invalidDouble[] = {
+    "", ".", "-", "+.", " 1.5", "1.5 ", "1.5.2", "abc", "1e999"
+  };
+  for (int i = 0; i < 9; i++) {
+    thrown = false;
+    try {
+      String(invalidDouble[i]).toDouble();
+    } catch (NumberFormatException& e) {
+      thrown = true;
+    }
+    assert(thrown);
+  }
+
+  // the fast path agrees with strtod()
+  srand(23);
+  for (int i = 0; i < 10000; i++) {
+    int len = sprintf(buf, "%d.%0*d", rand() % 1000000, rand() % 9 + 1,
+                      rand() % 100000000);
+    assert(String(buf, len).toDouble() == strtod(buf, 0));
+  }
+}
+
+/**
+ * Biased reference counting
+ */
+void testBiasedReferences() {
+  const char* text = "a value long enough to need a StringRef";
+
+  assert(!String::usesBiasedReferences());
+  String::useBiasedReferences(true);
+  assert(String::usesBiasedReferences());
+
+  // strings used only on the owner thread
+  String owned(text);
+  {
+    String copy(owned);
+    String other;
+    other = copy;
+    assert(other.data() == owned.data());
+  }
+  assert(owned == text);
+
+  // another thread copies and releases the owner's strings
+  std::thread copier([&owned, text]() {
+      for (int i = 0; i < 1000; i++) {
+        String copy(owned);
+        assert(copy == text);
+      }
+    });
+  for (int i = 0; i < 1000; i++) {
+    String copy(owned);
+    assert(copy == text);
+  }
+  copier.join();
+
+  // another thread releases the last references to the owner's strings
+  String* handed = new String[100];
+  for (int i = 0; i < 100; i++)
+    handed[i] = owned;
+  owned = "";
+  std::thread releaser([handed]() { delete [] handed; });
+  releaser.join();
+
+  // they are merged the next time the owner releases a string
+  String trigger(text);
+  String copy(trigger);
+  copy = "";
+
+  // the owner's strings remain valid after it stops biasing
+  String kept(trigger);
+  String::useBiasedReferences(false);
+  assert(!String::usesBiasedReferences());
+  kept = "";
+  assert(trigger == text);
+}
+
+/**
+ * Strings outliving the thread that owns them
+ */
+void testBiasedThreadExit() {
+  const char* text = "a value long enough to need a StringRef";
+  String result;
+  String extra;
+
+  std::thread owner([&result, &extra, text]() {
+      String::useBiasedReferences(true);
+      String value(text);
+      result = value;
+      extra = value;
+    });
+  owner.join();
+
+  // the owner has gone, so this release merges the counts itself
+  extra = "";
+  String copy(result);
+  result = "";
+  assert(copy == text);
+
+  // a new thread may take over the inactive owner
+  std::thread next([&copy, text]() {
+      String::useBiasedReferences(true);
+      String other(copy);
+      copy = "";
+      assert(other == text);
+    });
+  next.join();
+  assert(copy == "");
+}
+
 void testAssignmentOperator() {
   String str1("one");
   String str2("two");
@@ -148,6 +748,32 @@ void testAssignmentOperator() {
   assert(str2 == "three");
 }
 
+/**
+ * Move constructor and assignment tests
+ */
+void testMove() {
+  String longValue("a string long enough to be kept in a StringRef");
+  const char* data = longValue.data();
+
+  String moved(std::move(longValue));
+  assert(moved.data() == data);
+  assert(longValue.size() == 0);
+  assert(longValue == "");
+
+  String assigned("abc");
+  assigned = std::move(moved);
+  assert(assigned.data() == data);
+  assert(moved == "");
+
+  String shortValue("abc");
+  assigned = std::move(shortValue);
+  assert(assigned == "abc");
+  assert(shortValue == "");
+
+  assigned = std::move(assigned);
+  assert(assigned == "abc");
+}
+
 /**
  * assign() tests
  */
@@ -235,6 +861,32 @@ void testEqualityOperator() {
   assert(!(foo1 == "bar"));
 }
 
+/**
+ * hash() tests
+ */
+void testHash() {
+  String shortValue("key");
+  String longValue("a key long enough to be kept in a StringRef");
+  String sameValue(longValue.data());
+
+  assert(String::hash(shortValue) == hash_string("key", 3));
+  assert(String::hash(longValue) == hash_string(longValue, longValue.size()));
+
+  // the cached value is reused
+  assert(String::hash(longValue) == String::hash(longValue));
+  assert(String::hash(longValue) == String::hash(sameValue));
+
+  // slices use the hash of their own characters
+  String slice = longValue.slice(2, 30);
+  assert(String::hash(slice) == hash_string(longValue.data() + 2, 30));
+
+  // known hash values are used to rule out equality
+  String otherValue("a key long enough to be kept in a StringRed");
+  String::hash(otherValue);
+  assert(longValue != otherValue);
+  assert(longValue == sameValue);
+}
+
 /**
  * operator!=() tests
  */
@@ -363,24 +1015,274 @@ void testCompare() {
   assert(bar.compare("foo") < 0);
 }
 
+/**
+ * Comparison of data containing nulls, and of longer data
+ */
+void testBinaryCompare() {
+  String a("key\0alpha", 9);
+  String b("key\0beta", 8);
+  String prefix("key");
+
+  assert(a != b);
+  assert(a < b);
+  assert(b > a);
+  assert(a.compare(b) < 0);
+  assert(prefix < a);
+  assert(a > "key");
+  assert(a != "key");
+  assert(a.compare("key\0alpha", 9) == 0);
+
+  // bytes are compared as unsigned values
+  assert(String("\x80") > String("\x7f"));
+
+  // differences at every position of longer strings
+  char buf1[200], buf2[200];
+  for (int i = 0; i < 200; i++)
+    buf1[i] = buf2[i] = 'a' + (i % 26);
+
+  String base(buf1, 200);
+  for (int i = 0; i < 200; i++) {
+    buf2[i] = 'A';
+    String other(buf2, 200);
+    assert(base != other);
+    assert(base > other);
+    assert(other.compare(base) < 0);
+    assert(String(buf1, i + 1) != String(buf2, i + 1));
+    assert(String(buf1, i) == String(buf2, i));
+    buf2[i] = buf1[i];
+  }
+
+  assert(base == String(buf2, 200));
+  assert(base.compare(String(buf2, 199)) > 0);
+}
+
+/**
+ * find() tests
+ */
+void testFind() {
+  String str("the quick brown fox jumps over the lazy dog");
+
+  assert(str.find('q') == 4);
+  assert(str.find('t') == 0);
+  assert(str.find('t', 1) == 31);
+  assert(str.find('g', -1) == 42);
+  assert(str.find('z') == 37);
+  assert(str.find('!') == -1);
+  assert(str.find('t', 100) == -1);
+
+  assert(str.find("the") == 0);
+  assert(str.find("the", 1) == 31);
+  assert(str.find("dog") == 40);
+  assert(str.find("cat") == -1);
+  assert(str.find("") == 0);
+  assert(str.find("", 5) == 5);
+  assert(String("ab").find("abc") == -1);
+
+  // embedded nulls are searched like anything else
+  String binary("one\0two\0three", 13);
+  assert(binary.find('\0') == 3);
+  assert(binary.find("three") == 8);
+  assert(binary.find(String("\0t", 2), 4) == 7);
+}
+
+/**
+ * rfind() tests
+ */
+void testRfind() {
+  String str("the quick brown fox jumps over the lazy dog");
+
+  assert(str.rfind('t') == 31);
+  assert(str.rfind('g') == 42);
+  assert(str.rfind('!') == -1);
+  assert(str.rfind("the") == 31);
+  assert(str.rfind("quick") == 4);
+  assert(str.rfind("cat") == -1);
+  assert(str.rfind("") == 43);
+  assert(String().rfind('a') == -1);
+}
+
+/**
+ * contains(), startsWith() and endsWith() tests
+ */
+void testContains() {
+  String str("GET /index.html HTTP/1.1");
+
+  assert(str.contains(' '));
+  assert(!str.contains('?'));
+  assert(str.contains("/index"));
+  assert(!str.contains("POST"));
+
+  assert(str.startsWith("GET "));
+  assert(str.startsWith(""));
+  assert(!str.startsWith("POST"));
+  assert(!String("GE").startsWith("GET"));
+
+  assert(str.endsWith("HTTP/1.1"));
+  assert(str.endsWith(""));
+  assert(!str.endsWith("HTTP/1.0"));
+  assert(!String("1.1").endsWith("HTTP/1.1"));
+}
+
+/**
+ * count() tests
+ */
+void testCount() {
+  String str("a,b,,c,d");
+
+  assert(str.count(',') == 4);
+  assert(str.count('x') == 0);
+  assert(str.count(",,") == 1);
+  assert(String("aaaa").count("aa") == 2);
+  assert(str.count(",") == 4);
+  assert(str.count("") == 0);
+}
+
+/**
+ * Searches of long strings, compared with straightforward loops
+ */
+void testLongSearch() {
+  char buf[300];
+  for (int i = 0; i < 300; i++)
+    buf[i] = 'a' + (i * 7) % 13;
+
+  String str(buf, sizeof(buf));
+
+  for (int c = 'a'; c < 'a' + 14; c++) {
+    long first = -1, last = -1;
+    size_t total = 0;
+    for (int i = 0; i < 300; i++) {
+      if (buf[i] == c) {
+        if (first < 0) first = i;
+        last = i;
+        total++;
+      }
+    }
+
+    assert(str.find((char)c) == first);
+    assert(str.rfind((char)c) == last);
+    assert(str.count((char)c) == total);
+  }
+
+  for (size_t nlen = 2; nlen < 40; nlen += 3) {
+    for (size_t pos = 0; pos + nlen <= 300; pos += 17) {
+      String needle(buf + pos, nlen);
+
+      long first = -1, last = -1;
+      for (size_t i = 0; i + nlen <= 300; i++) {
+        if (memcmp(buf + i, buf + pos, nlen) == 0) {
+          if (first < 0) first = i;
+          last = i;
+        }
+      }
+
+      assert(str.find(needle) == first);
+      assert(str.rfind(needle) == last);
+    }
+  }
+
+  String missing("abcabc");
+  assert(str.find(missing) == -1);
+  assert(str.rfind(missing) == -1);
+}
+
+/**
+ * Splitting into a Vector
+ */
+void testSplit() {
+  Vector<String> fields;
+  assert(String("a,,bc,").split(',', fields) == 4);
+  assert(fields.size() == 4);
+  assert(fields[0] == "a");
+  assert(fields[1] == "");
+  assert(fields[2] == "bc");
+  assert(fields[3] == "");
+
+  // fields are appended
+  assert(String("").split(',', fields) == 1);
+  assert(String("xyz").split(',', fields) == 1);
+  assert(fields.size() == 6);
+  assert(fields[4] == "");
+  assert(fields[5] == "xyz");
+
+  Vector<String> words;
+  assert(String("one, two, three").split(String(", "), words) == 3);
+  assert(words[0] == "one");
+  assert(words[1] == "two");
+  assert(words[2] == "three");
+
+  Vector<String> whole;
+  assert(String("a, b").split(String(), whole) == 1);
+  assert(whole[0] == "a, b");
+
+  // long fields share the data of the string that was split
+  String line("the first field is long enough|and so is the second one");
+  Vector<String> shared;
+  assert(line.split('|', shared) == 2);
+  assert(shared[0] == "the first field is long enough");
+  assert(shared[0].data() == line.data());
+  assert(!shared[0].isTerminated());
+  assert(shared[1] == "and so is the second one");
+  assert(shared[1].data() == line.data() + 31);
+}
+
+/**
+ * Splitting with a function object
+ */
+void testSplitCallback() {
+  size_t total = 0;
+  size_t fields = String("1:22:333").split(':', [&total](const String& f) {
+      total += f.size();
+    });
+  assert(fields == 3);
+  assert(total == 6);
+
+  String last;
+  String("a--b--c").split(String("--"), [&last](String& f) {
+      last = std::move(f);
+    });
+  assert(last == "c");
+}
+
 int main(int argc, char** argv) {
 
     // run string tests
     testConstructor();
+    testStringRefCreate();
+    testLocalStorage();
     testData();
     testConversionOperator();
     testSize();
     testCharAt();
     testSubstring();
+    testSharedSubstring();
+    testSlice();
+    testLiteral();
+    testImmortal();
+    testAdopt();
+    testFromFile();
+    testFromNumber();
+    testToNumber();
+    testBiasedReferences();
+    testBiasedThreadExit();
     testAssignmentOperator();
+    testMove();
     testAssign();
     testEqualityOperator();
+    testHash();
     testInequalityOperator();
     testLessThanOperator();
     testGreaterThanOperator();
     testLessThanOrEqualToOperator();
     testGreaterThanOrEqualToOperator();
     testCompare();
+    testBinaryCompare();
+    testFind();
+    testRfind();
+    testContains();
+    testCount();
+    testLongSearch();
+    testSplit();
+    testSplitCallback();
 
     return 0;
 }
@@ -0,0 +1,249 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <assert.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <thread>
+
+#include <mcl/StringAllocator.h>
+#include <mcl/String.h>
+#include <mcl/StringBuilder.h>
+#include <mcl/OutOfBoundsException.h>
+
+using namespace mcl;
+
+
+/**
+ * An allocator counting the calls made to it
+ */
+class CountingAllocator : public MallocAllocator {
+
+public:
+  CountingAllocator() : allocations(0), frees(0) { }
+
+  void* allocate(size_t size) {
+    allocations++;
+    return MallocAllocator::allocate(size);
+  }
+
+  void deallocate(void* block, size_t size) {
+    frees++;
+    MallocAllocator::deallocate(block, size);
+  }
+
+  int allocations;
+  int frees;
+};
+
+/**
+ * Size class tests
+ */
+void testSizeClasses() {
+  assert(SlabAllocator::sizeClass(0) == 0);
+  assert(SlabAllocator::sizeClass(1) == 0);
+  assert(SlabAllocator::sizeClass(32) == 0);
+  assert(SlabAllocator::sizeClass(33) == 1);
+  assert(SlabAllocator::sizeClass(SlabAllocator::MAX_BLOCK) ==
+         SlabAllocator::SIZE_CLASSES - 1);
+  assert(SlabAllocator::sizeClass(SlabAllocator::MAX_BLOCK + 1) ==
+         SlabAllocator::SIZE_CLASSES);
+  assert(SlabAllocator::blockSize(SlabAllocator::SIZE_CLASSES - 1) ==
+         SlabAllocator::MAX_BLOCK);
+
+  // every size fits the block size of its class, and no smaller one
+  for (size_t size = 1; size <= SlabAllocator::MAX_BLOCK; size++) {
+    int c = SlabAllocator::sizeClass(size);
+    assert(SlabAllocator::blockSize(c) >= size);
+    if (c > 0)
+      assert(SlabAllocator::blockSize(c - 1) < size);
+  }
+
+  bool thrown = false;
+  try {
+    SlabAllocator::blockSize(SlabAllocator::SIZE_CLASSES);
+  } catch (OutOfBoundsException& e) {
+    thrown = true;
+  }
+  assert(thrown);
+}
+
+/**
+ * allocate(), reallocate() and deallocate() tests
+ */
+void testAllocate() {
+  SlabAllocator& slabs = SlabAllocator::instance();
+  assert(StringAllocator::current() == &slabs);
+
+  int c = SlabAllocator::sizeClass(100);
+  SlabAllocator::Stats before = slabs.stats(c);
+
+  void* blocks[1000];
+  for (int i = 0; i < 1000; i++) {
+    blocks[i] = slabs.allocate(100);
+    assert(blocks[i]);
+    memset(blocks[i], i, 100);
+  }
+  for (int i = 0; i < 1000; i++) {
+    assert(((unsigned char*)blocks[i])[99] == (unsigned char)i);
+    assert((size_t)blocks[i] % sizeof(void*) == 0);
+  }
+
+  SlabAllocator::Stats after = slabs.stats(c);
+  assert(after.blockSize == 128);
+  assert(after.allocations - before.allocations == 1000);
+  assert(after.bytesAllocated - before.bytesAllocated == 128000);
+  assert(after.bytesReserved >= 128000);
+
+  for (int i = 0; i < 1000; i++)
+    slabs.deallocate(blocks[i], 100);
+  after = slabs.stats(c);
+  assert(after.frees - before.frees == 1000);
+
+  // freed blocks are reused
+  void* again = slabs.allocate(100);
+  assert(again == blocks[999]);
+  slabs.deallocate(again, 100);
+
+  // resizing within a class keeps the block
+  void* block = slabs.allocate(100);
+  memcpy(block, "resized", 8);
+  assert(slabs.reallocate(block, 100, 120) == block);
+  block = slabs.reallocate(block, 120, 900);
+  assert(strcmp((char*)block, "resized") == 0);
+  block = slabs.reallocate(block, 900, 5000);
+  assert(strcmp((char*)block, "resized") == 0);
+  block = slabs.reallocate(block, 5000, 50000);
+  assert(strcmp((char*)block, "resized") == 0);
+  slabs.deallocate(block, 50000);
+
+  SlabAllocator::Stats large = slabs.stats(SlabAllocator::SIZE_CLASSES);
+  assert(large.blockSize == 0);
+  assert(large.allocations >= 2);
+  assert(large.allocations == large.frees);
+  assert(large.bytesAllocated == large.bytesFreed);
+}
+
+/**
+ * Blocks freed by other threads
+ */
+void testRemoteFree() {
+  SlabAllocator& slabs = SlabAllocator::instance();
+  int c = SlabAllocator::sizeClass(200);
+  SlabAllocator::Stats before = slabs.stats(c);
+
+  void* blocks[4][500];
+  for (int t = 0; t < 4; t++)
+    for (int i = 0; i < 500; i++)
+      blocks[t][i] = slabs.allocate(200);
+
+  std::thread threads[4];
+  for (int t = 0; t < 4; t++) {
+    threads[t] = std::thread([&slabs, &blocks, t]() {
+        // each thread frees blocks of this one and allocates its own
+        for (int i = 0; i < 500; i++) {
+          slabs.deallocate(blocks[t][i], 200);
+          void* own = slabs.allocate(200);
+          memset(own, t, 200);
+          slabs.deallocate(own, 200);
+        }
+      });
+  }
+  for (int t = 0; t < 4; t++)
+    threads[t].join();
+
+  SlabAllocator::Stats after = slabs.stats(c);
+  assert(after.allocations - before.allocations == 4000);
+  assert(after.frees - before.frees == 4000);
+
+  // the blocks are returned to this thread for reuse
+  for (int i = 0; i < 2000; i++) {
+    void* block = slabs.allocate(200);
+    bool found = false;
+    for (int t = 0; t < 4 && !found; t++)
+      for (int j = 0; j < 500 && !found; j++)
+        found = (blocks[t][j] == block);
+    assert(found);
+  }
+}
+
+/**
+ * Strings allocated and freed by many threads
+ */
+void testStrings() {
+  String shared("a string shared by every thread, long enough to be counted");
+  String results[4];
+
+  std::thread threads[4];
+  for (int t = 0; t < 4; t++) {
+    threads[t] = std::thread([&shared, &results, t]() {
+        String kept;
+        for (int i = 0; i < 10000; i++) {
+          String copy(shared);
+          StringBuilder b;
+          b.append(copy).append(' ').append(i);
+          String built = b.toString();
+          assert(built.startsWith(shared));
+          if (i % 1000 == 0)
+            kept = built;
+        }
+        results[t] = kept;
+      });
+  }
+  for (int t = 0; t < 4; t++)
+    threads[t].join();
+
+  // strings made by threads that have exited remain valid
+  for (int t = 0; t < 4; t++)
+    assert(results[t].endsWith(" 9000"));
+}
+
+/**
+ * Replacing the allocator
+ */
+void testUse() {
+  CountingAllocator counting;
+  String before("allocated before the allocator was replaced");
+
+  StringAllocator::use(&counting);
+  assert(StringAllocator::current() == &counting);
+  {
+    String a("a string allocated by the counting allocator");
+    String b(a);
+    assert(counting.allocations == 1);
+
+    StringBuilder builder;
+    builder.append('x', 1000);
+    String c = builder.toString();
+    assert(c.size() == 1000);
+    assert(counting.allocations == 2);
+
+    // strings from the previous allocator are returned to it
+    before = "";
+    assert(counting.frees == 0);
+  }
+  assert(counting.frees == 2);
+
+  StringAllocator::use(0);
+  assert(StringAllocator::current() == &SlabAllocator::instance());
+
+  String after("allocated after the allocator was restored");
+  assert(counting.allocations == 2);
+}
+
+int main(int argc, char** argv) {
+
+    testSizeClasses();
+    testAllocate();
+    testRemoteFree();
+    testStrings();
+    testUse();
+
+    return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
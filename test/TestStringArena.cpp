@@ -0,0 +1,220 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <assert.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <thread>
+
+#include <mcl/Rope.h>
+#include <mcl/StringArena.h>
+#include <mcl/String.h>
+#include <mcl/Vector.h>
+
+using namespace mcl;
+
+
+/**
+ * Strings allocated in an arena
+ */
+void testScope() {
+  const char* text = "a temporary value that lives only as long as its arena";
+  assert(StringArena::current() == 0);
+
+  String outside(text);
+  assert(!outside.inArena());
+
+  {
+    StringArena arena;
+    assert(StringArena::current() == &arena);
+    assert(arena.bytesUsed() == 0);
+
+    String a(text);
+    assert(a.inArena());
+    assert(a == text);
+    assert(a.isTerminated());
+    assert(arena.bytesUsed() == strlen(text) + 1);
+
+    // copies and slices share the arena data
+    String b(a);
+    assert(b.data() == a.data());
+    assert(b.inArena());
+    String slice = a.slice(2, 30);
+    assert(slice.data() == a.data() + 2);
+    assert(slice.inArena());
+
+    // compacting does not copy
+    slice.compact();
+    assert(slice.data() == a.data() + 2);
+
+    // short strings are still stored locally
+    String local("short");
+    assert(!local.inArena());
+
+    // strings created before the arena are unaffected
+    String copy(outside);
+    assert(copy.data() == outside.data());
+    assert(!copy.inArena());
+
+    // other constructors use the arena too
+    String repeated('x', 100);
+    assert(repeated.inArena());
+    assert(repeated.size() == 100);
+    String sub = outside.substring(1, 30);
+    assert(sub.inArena());
+    assert(sub == String(text + 1, 30));
+
+    assert(String::hash(a) == String::hash(outside));
+    assert(a == outside);
+
+    Vector<String> fields;
+    String line("alpha-alpha-alpha-alpha-alpha,beta-beta-beta-beta-beta");
+    line.split(',', fields);
+    assert(fields.size() == 2);
+    assert(fields[0].inArena());
+    assert(fields[1] == "beta-beta-beta-beta-beta");
+  }
+
+  assert(StringArena::current() == 0);
+  String after(text);
+  assert(!after.inArena());
+}
+
+/**
+ * promote() tests
+ */
+void testPromote() {
+  const char* text = "a value that has to outlive the arena it was made in";
+  String kept;
+  String slice;
+
+  {
+    StringArena arena;
+    String a(text);
+    kept = a;
+    slice = a.slice(5, 30);
+    assert(kept.inArena());
+
+    kept.promote();
+    assert(!kept.inArena());
+    assert(kept.data() != a.data());
+    assert(kept == text);
+
+    slice.promote();
+    assert(!slice.inArena());
+    assert(slice.size() == 30);
+    assert(slice.isTerminated());
+
+    // promoting a string not in the arena does nothing
+    String heap = kept;
+    heap.promote();
+    assert(heap.data() == kept.data());
+
+    // immortal strings are promoted first
+    String forever(text);
+    forever.makeImmortal();
+    assert(!forever.inArena());
+    assert(forever == text);
+  }
+
+  assert(kept == text);
+  assert(slice == String(text + 5, 30));
+}
+
+/**
+ * Nested arenas and large allocations
+ */
+void testNesting() {
+  StringArena outer(64);
+  String a("allocated from the outer arena, which is tiny");
+  size_t outerUsed = outer.bytesUsed();
+
+  {
+    StringArena inner;
+    assert(StringArena::current() == &inner);
+    String b("allocated from the inner arena instead of the outer");
+    assert(inner.bytesUsed() == b.size() + 1);
+    assert(outer.bytesUsed() == outerUsed);
+  }
+  assert(StringArena::current() == &outer);
+
+  // blocks grow as needed, and large strings get blocks of their own
+  Vector<String> strings;
+  char buf[64];
+  for (int i = 0; i < 1000; i++) {
+    snprintf(buf, sizeof(buf), "string number %d in the outer arena", i);
+    strings.append(String(buf));
+  }
+  String big('y', 100000);
+  String after("allocated after a large string, in the current block");
+  assert(big.inArena());
+  assert(after.inArena());
+  for (int i = 0; i < 1000; i++) {
+    snprintf(buf, sizeof(buf), "string number %d in the outer arena", i);
+    assert(strings[i] == buf);
+  }
+  assert(big.count('y') == 100000);
+  assert(outer.bytesReserved() >= outer.bytesUsed());
+  assert(outer.bytesUsed() >= 100001);
+}
+
+/**
+ * Arenas belong to a single thread
+ */
+void testThreads() {
+  StringArena arena;
+  String a("a string in the arena of the main thread");
+  bool otherInArena = true;
+  bool readable = false;
+
+  std::thread t([&a, &otherInArena, &readable]() {
+      String b("a string created by another thread");
+      otherInArena = b.inArena() || StringArena::current() != 0;
+      readable = (a == "a string in the arena of the main thread");
+    });
+  t.join();
+
+  assert(!otherInArena);
+  assert(readable);
+}
+
+/**
+ * Strings the library keeps are never left in an arena
+ */
+void testEscape() {
+  const char* text = "a piece of a rope that outlives the arena";
+  Rope rope;
+
+  {
+    StringArena arena;
+    String piece(text);
+    assert(piece.inArena());
+
+    // pieces are joined into a new leaf, which must not be in the arena
+    rope = Rope(piece.slice(0, 20)) + Rope(text + 20);
+    rope = rope + Rope(piece);
+    assert(arena.bytesUsed() > 0);
+  }
+
+  String flat = rope.flatten();
+  assert(flat.size() == 2 * strlen(text));
+  assert(flat.startsWith(text));
+  assert(flat.endsWith(text));
+}
+
+int main(int argc, char** argv) {
+
+    testScope();
+    testPromote();
+    testNesting();
+    testThreads();
+    testEscape();
+
+    return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
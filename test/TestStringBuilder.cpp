@@ -0,0 +1,160 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <assert.h>
+#include <limits.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <mcl/StringBuilder.h>
+
+using namespace mcl;
+
+
+/**
+ * Appending strings and characters
+ */
+void testAppend() {
+  StringBuilder b;
+  assert(b.size() == 0);
+  assert(b.capacity() == StringBuilder::INLINE_CAPACITY);
+
+  b.append("Content-").append(String("Type")).append(':').append(' ', 2);
+  b.append("text/plain; charset=utf-8", 10);
+  assert(b.size() == 25);
+  assert(memcmp(b.data(), "Content-Type:  text/plain", 25) == 0);
+
+  String s = b.toString();
+  assert(s == "Content-Type:  text/plain");
+  assert(b.size() == 0);
+
+  // embedded nulls are kept
+  b.append("a\0b", 3);
+  String nulls = b.toString();
+  assert(nulls.size() == 3);
+  assert(nulls.compare("a\0b", 3) == 0);
+
+  // an empty builder produces an empty string
+  assert(b.toString() == "");
+}
+
+/**
+ * Appending integers
+ */
+void testAppendIntegers() {
+  StringBuilder b;
+  b.append(0).append(',').append(42).append(',').append(-7);
+  b.append(',').append(1234567890L).append(',').append(3000000000U);
+  assert(b.toString() == "0,42,-7,1234567890,3000000000");
+
+  char expected[64];
+  sprintf(expected, "%lld,%lld,%llu", LLONG_MIN, LLONG_MAX, ULLONG_MAX);
+  b.append(LLONG_MIN).append(',').append(LLONG_MAX).append(',');
+  b.append(ULLONG_MAX);
+  assert(b.toString() == expected);
+}
+
+/**
+ * Appending floating-point numbers
+ */
+void testAppendDouble() {
+  StringBuilder b;
+  b.append(0.5).append(',').append(-2.0).append(',').append(0.1);
+  b.append(',').append(1e300);
+  assert(b.toString() == "0.5,-2,0.1,1e+300");
+}
+
+/**
+ * Growing beyond the inline buffer
+ */
+void testGrowth() {
+  StringBuilder b;
+  char expected[5000];
+
+  for (int i = 0; i < 500; i++) {
+    sprintf(expected + i * 9, "line %03d\n", i);
+    b.append("line ").append(i / 100).append(i / 10 % 10).append(i % 10);
+    b.append('\n');
+  }
+  assert(b.size() == 4500);
+  assert(b.capacity() >= 4500);
+
+  // the String takes over the builder's memory
+  const char* data = b.data();
+  String s = b.toString();
+  assert(s.size() == 4500);
+  assert(s == expected);
+  assert(s.data() == data || s.isTerminated());
+  assert(b.size() == 0);
+  assert(b.capacity() == StringBuilder::INLINE_CAPACITY);
+
+  // the builder may be used again
+  b.append(s).append(s);
+  assert(b.size() == 9000);
+  assert(b.toString().substring(4500) == s);
+}
+
+/**
+ * Appending data from the builder itself
+ */
+void testAppendOwnData() {
+  StringBuilder b;
+  b.append('x', 100);
+  b.append(b.data(), b.size());
+  b.append(b.data(), b.size());
+  assert(b.size() == 400);
+  assert(b.toString() == String('x', 400));
+}
+
+/**
+ * Reserving capacity
+ */
+void testReserve() {
+  StringBuilder b(1000);
+  assert(b.capacity() >= 1000);
+
+  b.append('y', 1000);
+  const char* data = b.data();
+  b.reserve(10);
+  assert(b.data() == data);
+
+  b.append('z');
+  assert(b.capacity() >= 2000);
+
+  b.clear();
+  assert(b.size() == 0);
+  b.append("short");
+  assert(b.toString() == "short");
+}
+
+/**
+ * Strings taken over from a StringBuilder with spare room, around the
+ * largest size the slab allocator handles
+ */
+void testToStringSizes() {
+  for (size_t n = 600; n <= 1100; n++) {
+    StringBuilder b;
+    for (size_t i = 0; i < n; i++)
+      b.append('a');
+    String s = b.toString();
+    assert(s.size() == n);
+    assert(s.count('a') == n);
+  }
+}
+
+int main(int argc, char** argv) {
+
+    testAppend();
+    testAppendIntegers();
+    testAppendDouble();
+    testGrowth();
+    testAppendOwnData();
+    testReserve();
+    testToStringSizes();
+
+    return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,169 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <assert.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <thread>
+
+#include <mcl/StringPool.h>
+
+using namespace mcl;
+
+
+/**
+ * intern() tests
+ */
+void testIntern() {
+  StringPool pool;
+
+  String a = pool.intern("content-type");
+  String b = pool.intern(String("content-type"));
+  String c = pool.intern("content-length");
+  String lit = pool.intern(String::literal("content-type", 12));
+
+  assert(a == "content-type");
+  assert(c == "content-length");
+  assert(a.data() == b.data());
+  assert(a.data() == lit.data());
+  assert(a.data() != c.data());
+  assert(a == b);
+  assert(a != c);
+  assert(pool.size() == 2);
+
+  // interned strings compare normally with other strings
+  assert(a == String("content-type"));
+  assert(String("content-type") == a);
+  assert(a.compare(c) > 0);
+
+  // strings from another pool are not canonical in this one
+  StringPool other;
+  String d = other.intern("content-type");
+  assert(d.data() != a.data());
+  assert(d == a);
+
+  // interned strings outlive their pool
+  String e;
+  {
+    StringPool temporary;
+    e = temporary.intern("a value that outlives the pool");
+  }
+  assert(e == "a value that outlives the pool");
+}
+
+/**
+ * evict() tests
+ */
+void testEvict() {
+  StringPool pool;
+
+  String kept = pool.intern("kept");
+  pool.intern("dropped");
+  assert(pool.size() == 2);
+
+  assert(pool.evict() == 1);
+  assert(pool.size() == 1);
+  assert(pool.intern("kept").data() == kept.data());
+
+  // an immortal copy of an interned string does not keep it in the pool
+  const char* text = "an immortal value too long to be stored locally";
+  String immortal = pool.intern(text);
+  immortal.makeImmortal();
+  assert(immortal == text);
+  assert(pool.evict() == 1);
+  assert(pool.size() == 1);
+  assert(immortal == pool.intern(text));
+
+  // the pool evicts unused entries instead of growing
+  StringPool small(4);
+  char buf[16];
+  for (int i = 0; i < 100; i++) {
+    sprintf(buf, "value%d", i);
+    small.intern(buf);
+  }
+  assert(small.size() <= 4);
+
+  // a pool that is nearly full of values in use grows rather than
+  // scanning the whole table for every new value, and its size stays
+  // in proportion to the values in use
+  StringPool busy(64);
+  String live[60];
+  for (int i = 0; i < 100000; i++) {
+    sprintf(buf, "key%d", i);
+    live[i % 60] = busy.intern(buf);
+  }
+  assert(busy.bucketCount() > 64);
+  assert(busy.bucketCount() <= 256);
+  assert(busy.size() <= busy.bucketCount());
+  for (int i = 0; i < 60; i++)
+    assert(busy.intern(live[i]).data() == live[i].data());
+}
+
+/**
+ * size() and bytesSaved() tests
+ */
+void testStatistics() {
+  StringPool pool;
+  assert(pool.size() == 0);
+  assert(pool.bytesSaved() == 0);
+
+  String a = pool.intern("metric.label");
+  assert(pool.bytesSaved() == 0);
+
+  String b = pool.intern("metric.label");
+  String c = pool.intern("metric.label");
+  assert(pool.size() == 1);
+  assert(pool.bytesSaved() == 2 * (sizeof(StringRef) + a.size() + 1));
+
+  // growing well beyond the initial capacity
+  char buf[16];
+  for (int i = 0; i < 1000; i++) {
+    sprintf(buf, "key%d", i);
+    String s = pool.intern(buf);
+    assert(s == buf);
+  }
+}
+
+/**
+ * Concurrent interning
+ */
+void testThreads() {
+  StringPool pool;
+  String results[4][100];
+
+  std::thread threads[4];
+  for (int t = 0; t < 4; t++) {
+    threads[t] = std::thread([&pool, &results, t]() {
+      char buf[16];
+      for (int i = 0; i < 100; i++) {
+        sprintf(buf, "key%d", i);
+        results[t][i] = pool.intern(buf);
+      }
+    });
+  }
+
+  for (int t = 0; t < 4; t++)
+    threads[t].join();
+
+  assert(pool.size() == 100);
+  for (int i = 0; i < 100; i++) {
+    for (int t = 1; t < 4; t++)
+      assert(results[t][i].data() == results[0][i].data());
+  }
+}
+
+int main(int argc, char** argv) {
+
+    testIntern();
+    testEvict();
+    testStatistics();
+    testThreads();
+
+    return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,117 @@
+// Copyright (c) 2007-2011, Jeffrey Hunter
+// See the LICENSE file distributed with this work for restrictions.
+
+#include <assert.h>
+#include <string.h>
+
+#include <mcl/StringTokenizer.h>
+
+using namespace mcl;
+
+
+/**
+ * Tokenizing on a character
+ */
+void testCharDelimiter() {
+  StringTokenizer tokens("a,,bc,", ',');
+  String field;
+
+  assert(tokens.hasNext());
+  assert(tokens.next(field) && field == "a");
+  assert(tokens.next(field) && field == "");
+  assert(tokens.next(field) && field == "bc");
+  assert(tokens.hasNext());
+  assert(tokens.next(field) && field == "");
+  assert(!tokens.hasNext());
+  assert(!tokens.next(field));
+  assert(field == "");
+
+  StringTokenizer single("abc", ',');
+  assert(single.next() == "abc");
+  assert(!single.hasNext());
+
+  StringTokenizer empty("", ',');
+  assert(empty.next() == "");
+  assert(!empty.hasNext());
+}
+
+/**
+ * Tokenizing on a string
+ */
+void testStringDelimiter() {
+  StringTokenizer tokens("one::two:three::", "::");
+
+  assert(tokens.next() == "one");
+  assert(tokens.next() == "two:three");
+  assert(tokens.next() == "");
+  assert(!tokens.hasNext());
+
+  StringTokenizer whole("a:b", "");
+  assert(whole.next() == "a:b");
+  assert(!whole.hasNext());
+}
+
+/**
+ * Fields share the data of the string being tokenized
+ */
+void testSharedFields() {
+  const char* longField = "a field that is too long to be stored locally";
+  char buf[100];
+  size_t len = strlen(longField);
+  memcpy(buf, longField, len);
+  buf[len] = '|';
+  memcpy(buf + len + 1, longField, len + 1);
+  String line(buf);
+  StringTokenizer tokens(line, '|');
+
+  String first = tokens.next();
+  assert(first == longField);
+  assert(first.data() == line.data());
+  assert(!first.isTerminated());
+
+  String second = tokens.next();
+  assert(second == longField);
+  assert(second.data() == line.data() + len + 1);
+  assert(second.isTerminated());
+
+  // fields remain valid after the original is reassigned
+  line = "x";
+  assert(first == longField);
+}
+
+/**
+ * Reading past the last field, and starting over
+ */
+void testReset() {
+  StringTokenizer tokens("a b", ' ');
+  assert(tokens.next() == "a");
+  assert(tokens.next() == "b");
+
+  bool thrown = false;
+  try {
+    tokens.next();
+  } catch (OutOfBoundsException& e) {
+    thrown = true;
+    assert(e.accessedIndex() == 2);
+  }
+  assert(thrown);
+
+  tokens.reset();
+  assert(tokens.next() == "a");
+  assert(tokens.string() == "a b");
+  assert(tokens.delimiter() == " ");
+}
+
+int main(int argc, char** argv) {
+
+    testCharDelimiter();
+    testStringDelimiter();
+    testSharedFields();
+    testReset();
+
+    return 0;
+}
+
+// Local Variables:
+// mode:C++
+// End:
@@ -4,8 +4,10 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <mcl/Vector.h>
+#include <mcl/String.h>
 
 using namespace mcl;
 
@@ -449,6 +451,364 @@ void testGrow() {
   assert(longList[23] == 24);
 }
 
+/**
+ * Move operation tests
+ */
+void testMove() {
+  const char* value = "a string long enough to be shared";
+
+  // moving items in and out of the list transfers their data
+  Vector<String> strings;
+  String a(value);
+  const char* data = a.data();
+
+  strings.push(std::move(a));
+  assert(a.size() == 0);
+  assert(strings[0].data() == data);
+
+  strings.unshift(String("first string, also long enough to share"));
+  strings.insert(1, String("second string, also long enough to share"));
+  assert(strings.size() == 3);
+  assert(strings[2].data() == data);
+
+  String b = strings.pop();
+  assert(b.data() == data);
+  assert(strings.shift() == "first string, also long enough to share");
+  assert(strings.remove(0) == "second string, also long enough to share");
+  assert(strings.size() == 0);
+
+  // moving the list itself
+  IntVector orig;
+  orig.push(1);
+  orig.push(2);
+
+  IntVector moved(std::move(orig));
+  assert(orig.size() == 0);
+  assert(moved.size() == 2);
+  assert(moved[1] == 2);
+
+  orig.push(3);
+  assert(orig.size() == 1);
+
+  IntVector assigned;
+  assigned.push(10);
+  assigned = std::move(moved);
+  assert(moved.size() == 0);
+  assert(assigned.size() == 2);
+  assert(assigned[0] == 1);
+}
+
+/**
+ * emplace() tests
+ */
+void testEmplace() {
+  Vector<String> strings;
+  strings.emplace("abc");
+  strings.emplace('x', 3);
+  strings.emplaceAt(0, "abcdef", 2);
+
+  assert(strings.size() == 3);
+  assert(strings[0] == "ab");
+  assert(strings[1] == "abc");
+  assert(strings[2] == "xxx");
+
+  try {
+    strings.emplaceAt(10, "abc");
+    fprintf(stderr, "Allowed emplacement at invalid index\n");
+    exit(1);
+  } catch (OutOfBoundsException&) {
+    // expected
+  }
+}
+
+/**
+ * An item that counts its live instances
+ */
+struct Counted {
+  static int live;
+  int value;
+
+  Counted(int v = 0) : value(v) { live++; }
+  Counted(const Counted& c) : value(c.value) { live++; }
+  ~Counted() { live--; }
+  bool operator!=(const Counted& c) const { return value != c.value; }
+};
+
+int Counted::live = 0;
+
+/**
+ * An item too large (and costly to copy) to be stored in the array
+ */
+struct Large {
+  char data[256];
+  Large(char c = 0) { memset(data, c, sizeof(data)); }
+  Large(const Large& l) { memcpy(data, l.data, sizeof(data)); }
+};
+
+/**
+ * An item that is stored separately by choice
+ */
+struct Pinned {
+  int value;
+  Pinned(int v = 0) : value(v) { }
+};
+
+namespace mcl {
+template <> struct vector_stores_pointers<Pinned> {
+  static const bool value = true;
+};
+}
+
+/**
+ * Storage of items in the array or separately
+ */
+void testStorage() {
+  assert(!vector_stores_pointers<int>::value);
+  assert(!vector_stores_pointers<String>::value);
+  assert(!vector_stores_pointers<Counted>::value);
+  assert(vector_stores_pointers<Large>::value);
+  assert(vector_stores_pointers<Pinned>::value);
+
+  // items in the array are contiguous
+  IntVector numbers(2);
+  for (int i = 0; i < 100; i++)
+    numbers.push(i);
+  assert(&numbers[50] == &numbers[0] + 50);
+
+  // items stored separately keep their addresses
+  Vector<Pinned> pinned(2);
+  pinned.push(Pinned(1));
+  Pinned* first = &pinned[0];
+  for (int i = 0; i < 100; i++)
+    pinned.unshift(Pinned(i));
+  assert(&pinned[100] == first);
+  assert(pinned[100].value == 1);
+
+  Vector<Large> large;
+  large.push(Large('a'));
+  large.insert(0, Large('b'));
+  assert(large[1].data[255] == 'a');
+  assert(large.remove(0).data[0] == 'b');
+
+  // items may be added from the list itself, even when it grows
+  IntVector self(2);
+  self.push(7);
+  self.push(8);
+  self.push(self[1]);       // grows
+  self.insert(0, self[2]);  // does not
+  self.prepend(self[1]);
+  assert(self.size() == 5);
+  assert(self[0] == 7 && self[1] == 8 && self[2] == 7 && self[3] == 8);
+  assert(self[4] == 8);
+
+  IntVector full(3);
+  full.push(1);
+  full.push(2);
+  full.push(3);
+  full.insert(1, full[2]);
+  assert(full.size() == 4);
+  assert(full[0] == 1 && full[1] == 3 && full[2] == 2 && full[3] == 3);
+
+  Vector<String> strings(1);
+  strings.push(String("a string long enough to be shared by copies"));
+  strings.push(strings[0]);
+  strings.insert(1, strings[1]);
+  assert(strings.size() == 3);
+  assert(strings[2] == strings[0]);
+
+  // every item constructed is destroyed
+  {
+    Vector<Counted> counted(4);
+    for (int i = 0; i < 50; i++)
+      counted.push(Counted(i));
+    counted.insert(10, Counted(-1));
+    counted.remove(20);
+    counted.shift();
+    assert(Counted::live == 49);
+
+    Vector<Counted> copy(counted);
+    assert(Counted::live == 98);
+    assert(copy == counted);
+    copy = counted;
+    assert(Counted::live == 98);
+    copy.clear();
+    assert(Counted::live == 49);
+  }
+  assert(Counted::live == 0);
+
+  Vector<int> none(0);
+  none.push(1);
+  assert(none[0] == 1);
+}
+
+/**
+ * reserve(), resize(), shrinkToFit() and growth policy tests
+ */
+void testCapacity() {
+  IntVector v(4);
+  assert(v.capacity() == 4);
+  assert(v.growthPolicy() == IntVector::GROW_DOUBLE);
+
+  // growth doubles by default (from at least 16)
+  for (int i = 0; i < 5; i++)
+    v.push(i);
+  assert(v.capacity() == 16);
+  for (int i = 5; i < 17; i++)
+    v.push(i);
+  assert(v.capacity() == 32);
+
+  v.setGrowthPolicy(IntVector::GROW_BY_HALF);
+  for (int i = 17; i < 33; i++)
+    v.push(i);
+  assert(v.capacity() == 48);
+
+  v.setGrowthPolicy(IntVector::GROW_FOUR_TIMES);
+  for (int i = 33; i < 49; i++)
+    v.push(i);
+  assert(v.capacity() == 192);
+  for (int i = 0; i < 49; i++)
+    assert(v[i] == i);
+
+  v.shrinkToFit();
+  assert(v.capacity() == 49);
+  assert(v[48] == 48);
+
+  // reserving makes room without changing the items
+  v.reserve(1000);
+  assert(v.capacity() == 1000);
+  assert(v.size() == 49);
+  v.reserve(10);
+  assert(v.capacity() == 1000);
+
+  v.resize(10);
+  assert(v.size() == 10);
+  assert(v[9] == 9);
+  v.resize(12);
+  assert(v[10] == 0 && v[11] == 0);
+  v.resize(15, v[9]);
+  assert(v.size() == 15);
+  assert(v[14] == 9);
+  v.resize(0);
+  v.shrinkToFit();
+  assert(v.capacity() == 0);
+  v.push(1);
+  assert(v[0] == 1);
+
+  // copies only take the room they need
+  IntVector big(1000);
+  big.push(1);
+  IntVector copy(big);
+  assert(copy.capacity() == 1);
+  assert(copy[0] == 1);
+
+  Vector<String> strings;
+  strings.resize(3, String("a string long enough to be shared by copies"));
+  assert(strings.size() == 3);
+  strings.resize(1);
+  assert(strings[0] == "a string long enough to be shared by copies");
+}
+
+/**
+ * appendRange() tests
+ */
+void testAppendRange() {
+  int numbers[100];
+  for (int i = 0; i < 100; i++)
+    numbers[i] = i;
+
+  IntVector v(4);
+  v.push(-1);
+  v.appendRange(numbers, 100);
+  assert(v.size() == 101);
+  assert(v.capacity() == 101);
+  assert(v[0] == -1 && v[100] == 99);
+
+  // items of the list itself, which moves as it grows
+  v.appendRange(&v[1], 100);
+  assert(v.size() == 201);
+  for (int i = 0; i < 100; i++)
+    assert(v[101 + i] == i);
+
+  IntVector other;
+  other.appendRange(v);
+  assert(other == v);
+  other.appendRange(other);
+  assert(other.size() == 402);
+  assert(other[201] == -1 && other[401] == 99);
+
+  Vector<String> strings;
+  strings.push(String("first string, long enough to be shared"));
+  strings.push(String("second string, long enough to be shared"));
+  strings.appendRange(strings);
+  strings.appendRange(&strings[1], 3);
+  assert(strings.size() == 7);
+  assert(strings[6] == strings[1]);
+  assert(strings[5] == strings[0]);
+}
+
+/**
+ * An item that counts the times it is copied or moved, and may be
+ * moved bitwise instead
+ */
+struct Relocated {
+  static int copies;
+  int value;
+
+  Relocated(int v = 0) : value(v) { }
+  Relocated(const Relocated& r) : value(r.value) { copies++; }
+  Relocated(Relocated&& r) : value(r.value) { copies++; }
+  bool operator!=(const Relocated& r) const { return value != r.value; }
+};
+
+int Relocated::copies = 0;
+
+_MCL_TRIVIALLY_RELOCATABLE(Relocated)
+
+/**
+ * Moving trivially relocatable items
+ */
+void testRelocation() {
+  assert(is_trivially_relocatable<int>::value);
+  assert(is_trivially_relocatable<String>::value);
+  assert(is_trivially_relocatable<IntVector>::value);
+  assert(is_trivially_relocatable<Relocated>::value);
+  assert(!is_trivially_relocatable<Counted>::value);
+
+  // growing, inserting and removing move items without copying them
+  Vector<Relocated> v(1);
+  for (int i = 0; i < 1000; i++)
+    v.emplace(i);
+  v.emplaceAt(0, -1);
+  v.emplaceAt(500, -2);
+  v.remove(10);
+  v.shrinkToFit();
+  v.reserve(5000);
+  assert(Relocated::copies == 1);  // remove() returns a copy
+  assert(v.size() == 1001);
+  assert(v[0].value == -1 && v[499].value == -2 && v[1000].value == 999);
+  assert(v[10].value == 10);
+
+  // inserting a copy of an item while the list grows
+  Vector<Relocated> w(2);
+  w.emplace(1);
+  w.emplace(2);
+  w.insert(1, w[1]);
+  assert(w[0].value == 1 && w[1].value == 2 && w[2].value == 2);
+
+  // Strings keep their data and counts when moved
+  const char* text = "a string long enough to be shared by its copies";
+  Vector<String> strings(1);
+  String s(text);
+  for (int i = 0; i < 100; i++)
+    strings.push(s);
+  strings.unshift(String("first"));
+  strings.remove(50);
+  assert(strings.size() == 100);
+  assert(strings[99].data() == s.data());
+  strings.clear();
+  assert(s == text);
+}
+
 int main(int argc, char** argv) {
   
   testConstructor();
@@ -467,6 +827,12 @@ int main(int argc, char** argv) {
   testEquality();
   testInequality();
   testGrow();
+  testMove();
+  testEmplace();
+  testStorage();
+  testCapacity();
+  testAppendRange();
+  testRelocation();
   
   return 0;
 }